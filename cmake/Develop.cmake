@@ -34,3 +34,17 @@ if(ENABLE_WARNING)
                         # -Wfatal-errors
                         )
 endif()
+
+if(ENABLE_LATENCY_HISTOGRAM)
+    set(CO_CONTEXT_USE_LATENCY_HISTOGRAM ON)
+    message(NOTICE "latency histograms of lazy_io enabled")
+else()
+    set(CO_CONTEXT_USE_LATENCY_HISTOGRAM OFF)
+endif()
+
+if(ENABLE_TRACE)
+    set(CO_CONTEXT_USE_TRACE ON)
+    message(NOTICE "coroutine tracing enabled")
+else()
+    set(CO_CONTEXT_USE_TRACE OFF)
+endif()
@@ -11,6 +11,8 @@ option(ENABLE_SANITIZER "Enable address sanitizer(Debug+Gcc/Clang/AppleClang)" O
 option(ENABLE_WARNING "Enable warning for all project " ON)
 option(ENABLE_CCACHE "Use ccache to faster compile when develop" OFF)
 option(ENABLE_COVERAGE_TEST "Build test with coverage" OFF)
+option(ENABLE_LATENCY_HISTOGRAM "Record latency histograms of lazy_io per opcode" OFF)
+option(ENABLE_TRACE "Record the lifecycle of coroutines for trace_start()" OFF)
 
 # ----------------------------------------------------------------------------
 #   Extra options
@@ -0,0 +1,59 @@
+#include <co_context/io_context.hpp>
+#include <co_context/lazy_io.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+using namespace co_context;
+using namespace std::chrono_literals;
+
+io_context hub;
+
+task<> report(int round) {
+    printf("hub: round %d reported\n", round);
+    co_return;
+}
+
+task<> job(int round) {
+    printf(
+        "helper of round %d is running, io_context at %p\n", round,
+        static_cast<void *>(&this_io_context())
+    );
+    hub.co_spawn(report(round));
+    this_io_context().can_stop();
+    co_return;
+}
+
+task<> heartbeat() {
+    for (;;) {
+        co_await timeout(1s);
+    }
+}
+
+int main() {
+    hub.co_spawn(heartbeat());
+    hub.start();
+
+    // Helpers join and leave while the hub keeps running. No io_context has
+    // to wait for the others to start.
+    for (int round = 0; round < 3; ++round) {
+        auto helper = std::make_unique<io_context>(io_context_options::compact()
+        );
+        helper->co_spawn(job(round));
+        helper->start();
+        helper->join();
+    }
+
+    hub.join(); // never stop
+    return 0;
+}
+
+/*
+Output (the order between the hub and the helpers may vary):
+helper of round 0 is running, io_context at 0x5...
+helper of round 1 is running, io_context at 0x5...
+helper of round 2 is running, io_context at 0x5...
+hub: round 0 reported
+hub: round 1 reported
+hub: round 2 reported
+*/
@@ -0,0 +1,43 @@
+// echo_server whose idle connections hold no buffer
+#include <co_context/net.hpp>
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
+using namespace co_context;
+
+task<> session(int sockfd, buffer_group &group) {
+    co_context::socket sock{sockfd};
+
+    while (true) {
+        provided_buffer buf = co_await sock.recv(group);
+        if (!buf) {
+            break;
+        }
+        co_await sock.send(buf.span());
+        // `buf` goes back to the group here, before waiting for the next.
+    }
+    co_await sock.close();
+}
+
+task<> server(const uint16_t port) {
+    // 1024 buffers shared by all connections of this io_context.
+    buffer_group group{1024, 8192};
+
+    acceptor ac{inet_address{port}};
+    for (int sock; (sock = co_await ac.accept()) >= 0;) {
+        co_spawn(session(sock, group));
+    }
+}
+
+int main() {
+    io_context ctx;
+    ctx.co_spawn(server(1234));
+    ctx.start();
+    ctx.join();
+    return 0;
+}
+#else
+int main() {
+    // buffer rings need Linux 5.19.
+    return 0;
+}
+#endif
@@ -0,0 +1,39 @@
+// echo_server on direct descriptors, allocated from the file table
+#include <co_context/net.hpp>
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
+using namespace co_context;
+
+task<> session(int file_index) {
+    direct_socket sock{file_index};
+    char buf[8192];
+
+    for (int nr; (nr = co_await sock.recv(buf)) > 0;) {
+        co_await sock.send({buf, (size_t)nr});
+    }
+    co_await sock.close();
+}
+
+task<> server(const uint16_t port) {
+    acceptor ac{inet_address{port}};
+    accept_stream stream = ac.accept_direct_stream();
+    for (int slot; (slot = co_await stream.next()) >= 0;) {
+        co_spawn(session(slot));
+    }
+}
+
+int main() {
+    io_context_options options;
+    options.fixed_file_num = 4096;
+    io_context ctx{options};
+    ctx.co_spawn(server(1234));
+    ctx.start();
+    ctx.join();
+    return 0;
+}
+#else
+int main() {
+    // direct descriptors need Linux 5.19.
+    return 0;
+}
+#endif
@@ -0,0 +1,39 @@
+#include <co_context/net.hpp>
+using namespace co_context;
+
+// Echo with buffers registered to the ring. Falls back to a plain buffer
+// once all registered ones are lent.
+task<> session(int sockfd) {
+    co_context::socket sock{sockfd};
+    fixed_buffer buf = this_io_context().fixed_buffers().try_acquire();
+
+    if (!buf) {
+        char plain[8192];
+        for (int nr; (nr = co_await sock.recv(plain)) > 0;) {
+            co_await sock.send({plain, (size_t)nr});
+        }
+    } else {
+        for (int nr; (nr = co_await sock.recv(buf)) > 0;) {
+            co_await sock.send(buf, (size_t)nr);
+        }
+    }
+    co_await sock.close();
+}
+
+task<> server(const uint16_t port) {
+    acceptor ac{inet_address{port}};
+    for (int sock; (sock = co_await ac.accept()) >= 0;) {
+        co_spawn(session(sock));
+    }
+}
+
+int main() {
+    io_context_options options;
+    options.fixed_buffer_num = 1024;
+    options.fixed_buffer_size = 8192;
+    io_context ctx{options};
+    ctx.co_spawn(server(1234));
+    ctx.start();
+    ctx.join();
+    return 0;
+}
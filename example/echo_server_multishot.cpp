@@ -0,0 +1,42 @@
+// echo_server receiving by one multishot request per connection
+#include <co_context/net.hpp>
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 20)
+using namespace co_context;
+
+task<> session(int sockfd, buffer_group &group) {
+    co_context::socket sock{sockfd};
+    recv_stream stream = sock.recv_multishot(group);
+
+    while (true) {
+        provided_buffer buf = co_await stream.next();
+        if (!buf) {
+            break;
+        }
+        co_await sock.send(buf.span());
+    }
+    co_await sock.close();
+}
+
+task<> server(const uint16_t port) {
+    buffer_group group{1024, 8192};
+
+    acceptor ac{inet_address{port}};
+    for (int sock; (sock = co_await ac.accept()) >= 0;) {
+        co_spawn(session(sock, group));
+    }
+}
+
+int main() {
+    io_context ctx;
+    ctx.co_spawn(server(1234));
+    ctx.start();
+    ctx.join();
+    return 0;
+}
+#else
+int main() {
+    // multishot recv needs Linux 6.0.
+    return 0;
+}
+#endif
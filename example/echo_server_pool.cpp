@@ -0,0 +1,36 @@
+// multi-threaded echo_server, with each worker pinned to a physical core
+#include <co_context/io_context_pool.hpp>
+#include <co_context/net.hpp>
+using namespace co_context;
+
+constexpr uint32_t worker_num = 4;
+static_assert(worker_num > 0);
+io_context_pool workers{
+    worker_num, io_context_pool::placement::per_physical_core
+};
+io_context balancer;
+
+task<> session(int sockfd) {
+    co_context::socket sock{sockfd};
+    char buf[8192];
+    int nr = co_await sock.recv(buf);
+
+    while (nr > 0) {
+        nr = co_await (sock.send({buf, (size_t)nr}) && sock.recv(buf));
+    }
+}
+
+task<> server(const uint16_t port) {
+    acceptor ac{inet_address{port}};
+    for (int sock; (sock = co_await ac.accept()) >= 0;) {
+        workers.spawn_any(session(sock));
+    }
+}
+
+int main() {
+    balancer.co_spawn(server(1234));
+    balancer.start();
+    workers.start();
+    balancer.join(); // never stop
+    return 0;
+}
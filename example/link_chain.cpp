@@ -0,0 +1,45 @@
+#include <co_context/io_context.hpp>
+#include <co_context/lazy_io.hpp>
+#include <co_context/link_chain.hpp>
+
+#include <fcntl.h>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+using namespace co_context;
+
+// Write the fragments in order, then fsync, by one submission.
+task<> write_all(const char *path, std::vector<std::string_view> fragments) {
+    const int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("open");
+        co_return;
+    }
+
+    link_chain chain;
+    uint64_t offset = 0;
+    for (std::string_view fragment : fragments) {
+        chain.push(lazy::write(fd, fragment, offset));
+        offset += fragment.size();
+    }
+    chain.push(lazy::fsync(fd, 0));
+
+    const int res = co_await chain;
+    for (size_t i = 0; i < chain.size(); ++i) {
+        printf("step %zu: %d\n", i, chain.result(i));
+    }
+    printf("fsync: %d\n", res);
+    co_await lazy::close(fd);
+    this_io_context().can_stop();
+}
+
+int main() {
+    io_context ctx;
+    ctx.co_spawn(write_all(
+        "link_chain.txt", {"HTTP/1.1 200 OK\r\n", "Content-Length: 5\r\n",
+                           "\r\n", "hello"}
+    ));
+    ctx.start();
+    ctx.join();
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include <co_context/io_context.hpp>
+#include <co_context/lazy_io.hpp>
+
+#include <iostream>
+
+using namespace co_context;
+
+io_context ctx;
+int bulk_rounds = 0;
+
+task<> bulk() {
+    for (int i = 0; i < 100; ++i) {
+        ++bulk_rounds;
+        co_await lazy::yield();
+    }
+}
+
+task<> heartbeat() {
+    for (int i = 0; i < 5; ++i) {
+        // Resumed ahead of most of the bulk coroutines.
+        std::cout << "heartbeat " << i << ": bulk rounds = " << bulk_rounds
+                  << std::endl;
+        co_await lazy::yield();
+    }
+}
+
+task<> admin() {
+    co_await lazy::set_priority(priority::low);
+    co_await lazy::yield();
+    // Still resumed, though the lower lane gets fewer turns.
+    std::cout << "admin: bulk rounds = " << bulk_rounds << std::endl;
+}
+
+int main() {
+    for (int i = 0; i < 1000; ++i) {
+        ctx.co_spawn(bulk());
+    }
+    ctx.co_spawn(admin());
+    ctx.co_spawn(heartbeat(), priority::high);
+
+    ctx.start();
+    ctx.join();
+    return 0;
+}
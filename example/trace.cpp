@@ -0,0 +1,38 @@
+// Build co_context with `-DENABLE_TRACE=ON`, run this, then open
+// "trace.json" in https://ui.perfetto.dev
+#include <co_context/io_context.hpp>
+#include <co_context/lazy_io.hpp>
+#include <co_context/trace.hpp>
+
+#include <chrono>
+#include <cstdio>
+using namespace co_context;
+using namespace std::chrono_literals;
+
+io_context ctx[2];
+
+task<> ping_pong(int rounds) {
+    for (int i = 0; i < rounds; ++i) {
+        co_await timeout(100us);
+        co_await resume_on(ctx[(i + 1) % 2]);
+    }
+
+    trace_stop();
+    if (trace_to_chrome_json("trace.bin", "trace.json")) {
+        printf("trace.json is written\n");
+    }
+}
+
+int main() {
+    if (!trace_start("trace.bin")) {
+        printf("tracing is not enabled\n");
+    }
+
+    ctx[0].co_spawn(ping_pong(100));
+    for (auto &c : ctx) {
+        c.start();
+    }
+
+    ctx[0].join(); // never stop
+    return 0;
+}
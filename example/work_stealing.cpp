@@ -0,0 +1,51 @@
+#include <co_context/io_context.hpp>
+#include <co_context/lazy_io.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+using namespace co_context;
+
+constexpr int ctx_num = 4;
+constexpr int task_num = 1000;
+constexpr int round_num = 10;
+
+io_context ctx[ctx_num];
+std::atomic_int rounds_on[ctx_num];
+std::atomic_int finished = 0;
+
+void busy_wait(std::chrono::microseconds duration) {
+    const auto deadline = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < deadline) {}
+}
+
+task<> cpu_bound() {
+    for (int i = 0; i < round_num; ++i) {
+        busy_wait(std::chrono::microseconds{100});
+        ++rounds_on[&this_io_context() - ctx];
+        co_await lazy::yield();
+    }
+
+    if (++finished == task_num) {
+        for (int i = 0; i < ctx_num; ++i) {
+            std::cout << "ctx[" << i << "] ran " << rounds_on[i] << " rounds\n";
+        }
+        std::cout << std::flush;
+    }
+}
+
+int main() {
+    // All the tasks are spawned to ctx[0], then shared with the others.
+    for (int i = 0; i < task_num; ++i) {
+        ctx[0].co_spawn(cpu_bound());
+    }
+
+    for (auto &c : ctx) {
+        c.set_work_stealing(true);
+        c.start();
+    }
+
+    ctx[0].join(); // never stop
+    return 0;
+}
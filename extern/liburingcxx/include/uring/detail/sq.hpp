@@ -25,6 +25,7 @@ namespace detail {
         unsigned sqe_head;      // memset to 0 during uring()
         unsigned sqe_tail;      // memset to 0 during uring()
         unsigned sqe_free_head; // memset to 0 during uring()
+        unsigned setup_flags;   // the actual flags of io_uring_setup
 
         unsigned *khead;
         unsigned *ktail;
@@ -51,6 +52,20 @@ namespace detail {
             // NOLINTEND
         }
 
+        /**
+         * @brief If the kernel polls the SQ. Folded at compile time when
+         * SQPOLL is given by `uring_flags`.
+         */
+        template<uint64_t uring_flags>
+        [[nodiscard]]
+        inline bool is_sqpoll() const noexcept {
+            if constexpr (uring_flags & IORING_SETUP_SQPOLL) {
+                return true;
+            } else {
+                return setup_flags & IORING_SETUP_SQPOLL;
+            }
+        }
+
         void init_free_queue() noexcept {
             std::iota(array, array + ring_entries, 0);
         }
@@ -58,25 +73,27 @@ namespace detail {
         /**
          * @brief Sync internal state with kernel ring state on the SQ side.
          *
+         * @param held Number of the latest sqes not to be added, which may
+         * still be modified.
          * @return unsigned number of pending items in the SQ ring, for the
          * shared ring.
          */
         template<uint64_t uring_flags>
-        unsigned flush() noexcept {
-            if (sqe_tail != sqe_head) [[likely]] {
+        unsigned flush(unsigned held = 0) noexcept {
+            if (sqe_tail - sqe_head > held) [[likely]] {
                 /*
                  * Fill in sqes that we have queued up, adding them to the
                  * kernel ring
                  */
-                sqe_head = sqe_tail; // Here is the only usage of sqe_head.
+                sqe_head = sqe_tail - held; // the only usage of sqe_head
                 /*
                  * Ensure that the kernel sees the SQE updates before it sees
                  * the tail update.
                  */
-                if constexpr (!(uring_flags & IORING_SETUP_SQPOLL)) {
-                    IO_URING_WRITE_ONCE(*ktail, sqe_tail);
+                if (!is_sqpoll<uring_flags>()) {
+                    IO_URING_WRITE_ONCE(*ktail, sqe_head);
                 } else {
-                    io_uring_smp_store_release(ktail, sqe_tail);
+                    io_uring_smp_store_release(ktail, sqe_head);
                 }
             }
             /*
@@ -91,7 +108,7 @@ namespace detail {
              * able to deal with this situation regardless of any perceived
              * atomicity.
              */
-            return sqe_tail - *khead;
+            return sqe_head - *khead;
         }
 
         /**
@@ -108,7 +125,7 @@ namespace detail {
              * wasn't ready. We don't need the load acquire for non-SQPOLL since
              * then we drive updates.
              */
-            if constexpr (uring_flags & IORING_SETUP_SQPOLL) {
+            if (is_sqpoll<uring_flags>()) {
                 return sqe_tail - io_uring_smp_load_acquire(khead);
             }
             /* always use real head, to avoid losing sync for short submit */
@@ -145,7 +162,7 @@ namespace detail {
                 bool(uring_flags & IORING_SETUP_SQE128) ? 1 : 0;
 
             unsigned int head;
-            if constexpr (!(uring_flags & IORING_SETUP_SQPOLL)) {
+            if (!is_sqpoll<uring_flags>()) {
                 head = IO_URING_READ_ONCE(*khead);
             } else {
                 head = io_uring_smp_load_acquire(khead);
@@ -167,6 +184,32 @@ namespace detail {
             }
         }
 
+        /**
+         * @brief Number of the unsubmitted sqes just before the latest one
+         * that are linked to their next, i.e. a link still being built.
+         */
+        template<uint64_t uring_flags>
+        [[nodiscard]]
+        unsigned linked_before_latest() const noexcept {
+            constexpr int shift =
+                bool(uring_flags & IORING_SETUP_SQE128) ? 1 : 0;
+
+            unsigned num = 0;
+            if (sqe_tail == sqe_head) {
+                return num;
+            }
+            for (unsigned i = sqe_tail - 1; i != sqe_head; --i, ++num) {
+                unsigned index = (i - 1) & ring_mask;
+                if constexpr (uring_flags & uring_setup::sqe_reorder) {
+                    index = array[index];
+                }
+                if (!sqes[index << shift].is_linked()) {
+                    break;
+                }
+            }
+            return num;
+        }
+
         inline void append_sq_entry(const sq_entry *const sqe) noexcept {
             array[sqe_tail++ & ring_mask] = sqe - sqes;
             assert(sqe_tail - *khead <= ring_entries);
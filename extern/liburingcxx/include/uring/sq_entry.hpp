@@ -44,6 +44,10 @@ class sq_entry final : private io_uring_sqe {
 
     inline __u64 &fetch_data() noexcept { return this->user_data; }
 
+    [[nodiscard]] inline uint8_t get_opcode() const noexcept {
+        return this->opcode;
+    }
+
     inline sq_entry &reset_flags(uint8_t flags) noexcept {
         this->flags = flags;
         return *this;
@@ -60,6 +64,11 @@ class sq_entry final : private io_uring_sqe {
         return *this;
     }
 
+    // if the next sqe is linked to this one, by set_link() or set_hard_link()
+    [[nodiscard]] inline bool is_linked() const noexcept {
+        return (this->flags & (IOSQE_IO_LINK | IOSQE_IO_HARDLINK));
+    }
+
     inline sq_entry &set_hard_link() noexcept {
         this->flags |= IOSQE_IO_HARDLINK;
         return *this;
@@ -81,6 +90,13 @@ class sq_entry final : private io_uring_sqe {
         return *this;
     }
 
+    // Select the buffer from the given group, see `set_buffer_select()`.
+    inline sq_entry &set_buffer_select(uint16_t bgid) noexcept {
+        this->flags |= IOSQE_BUFFER_SELECT;
+        this->buf_group = bgid;
+        return *this;
+    }
+
 #if LIBURINGCXX_IS_KERNEL_REACH(5, 17)
     // see `man io_uring_enter`
     // available since Linux 5.17
@@ -550,6 +566,18 @@ class sq_entry final : private io_uring_sqe {
         return *this;
     }
 
+    /**
+     * @brief recv at most `len` bytes into a buffer selected from the group
+     * `bgid`, see `set_buffer_select()`.
+     */
+    inline sq_entry &prep_recv_select(
+        int sockfd, uint32_t len, int flags, uint16_t bgid
+    ) noexcept {
+        prep_rw(IORING_OP_RECV, sockfd, nullptr, len, 0);
+        this->msg_flags = (uint32_t)flags;
+        return set_buffer_select(bgid);
+    }
+
 #if LIBURINGCXX_IS_KERNEL_REACH(5, 20)
     /**
      * @brief same as recv but generate multi-CQE, see
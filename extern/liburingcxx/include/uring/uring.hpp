@@ -106,7 +106,7 @@ class [[nodiscard]] uring final {
 
     submission_queue sq;
     completion_queue cq;
-    // unsigned flags; // is now uring_flags
+    unsigned flags; // uring_flags | the runtime flags given by params
     int ring_fd = -1;
 
     unsigned features;
@@ -118,8 +118,42 @@ class [[nodiscard]] uring final {
   public:
     int fd() const noexcept { return ring_fd; }
 
+    /**
+     * @brief The flags actually used by io_uring_setup.
+     */
+    [[nodiscard]]
+    unsigned setup_flags() const noexcept { return flags; }
+
+    /**
+     * @brief IORING_FEAT_* reported by io_uring_setup.
+     */
+    [[nodiscard]]
+    unsigned feature_bits() const noexcept { return features; }
+
+    /**
+     * @brief Number of invalid sqes dropped by the kernel.
+     */
+    [[nodiscard]]
+    unsigned sq_dropped() const noexcept {
+        return io_uring_smp_load_acquire(sq.kdropped);
+    }
+
+    /**
+     * @brief Number of cqes lost because the cq ring was full.
+     */
+    [[nodiscard]]
+    unsigned cq_overflow() const noexcept {
+        return io_uring_smp_load_acquire(cq.koverflow);
+    }
+
     int submit() noexcept;
 
+    /**
+     * @brief Submit all sqes but the latest `held` ones, which may still be
+     * modified, e.g. to be linked to the next sqe.
+     */
+    int submit_all_but(unsigned held) noexcept;
+
     int submit_and_wait(unsigned wait_num) noexcept;
 
 #if LIBURINGCXX_IS_KERNEL_REACH(5, 11)
@@ -147,6 +181,15 @@ class [[nodiscard]] uring final {
     [[nodiscard]]
     sq_entry *get_sq_entry() noexcept;
 
+    /**
+     * @brief Number of the unsubmitted sqes just before the latest one that
+     * are linked to their next, i.e. a link still being built.
+     */
+    [[nodiscard]]
+    unsigned linked_before_latest() const noexcept {
+        return sq.template linked_before_latest<uring_flags>();
+    }
+
     void append_sq_entry(const sq_entry *sqe) noexcept;
 
     int wait_sq_ring();
@@ -197,6 +240,46 @@ class [[nodiscard]] uring final {
 
     int unregister_ring_fd();
 
+    /**
+     * @brief Register `nr` buffers for read_fixed/write_fixed, the i-th one
+     * with buf_index i. The pages are pinned until unregister_buffers().
+     * @return 0, or -errno on failure.
+     */
+    int register_buffers(const iovec *iovecs, unsigned nr) noexcept;
+
+    int unregister_buffers() noexcept;
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
+    /**
+     * @brief Register a file table of `nr` empty slots for direct
+     * descriptors. The kernel allocates a free slot for each request with
+     * IORING_FILE_INDEX_ALLOC.
+     * @return 0, or -errno on failure.
+     */
+    int register_files_sparse(unsigned nr) noexcept;
+#endif
+
+    int unregister_files() noexcept;
+
+    /**
+     * @brief Ask the kernel which opcodes it supports, filling `probe` with
+     * up to `nr_ops` entries of io_uring_probe_op.
+     * @return 0, or -errno on failure, e.g. -EINVAL before linux 5.6.
+     */
+    int register_probe(io_uring_probe *probe, unsigned nr_ops) noexcept;
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
+    /**
+     * @brief Register a ring of provided buffers as the buffer group `bgid`.
+     * @param br Page-aligned memory of `entries` io_uring_buf.
+     * @return 0, or -errno on failure.
+     */
+    int
+    register_buf_ring(buf_ring *br, unsigned entries, uint16_t bgid) noexcept;
+
+    int unregister_buf_ring(uint16_t bgid) noexcept;
+#endif
+
     [[nodiscard]]
     constexpr bool is_cq_ring_need_enter() const noexcept;
 
@@ -205,6 +288,10 @@ class [[nodiscard]] uring final {
      * @brief Init the io_uring.
      * @note Must be call on the Corresponding thread. (Ring per thread)
      * @param entries The size of sq ring. Must be pow of 2.
+     * @param params `params.flags` is OR-ed with `uring_flags`, so that the
+     * flags can be chosen at runtime. The hot paths still fold the SQPOLL
+     * checks if it is given by `uring_flags`.
+     * @throw std::system_error if io_uring_setup fails.
      */
     void init(unsigned entries);
     void init(unsigned entries, params &params);
@@ -280,6 +367,11 @@ inline int uring<uring_flags>::submit() noexcept {
     return submit_and_wait(0);
 }
 
+template<uint64_t uring_flags>
+inline int uring<uring_flags>::submit_all_but(unsigned held) noexcept {
+    return __submit(sq.template flush<uring_flags>(held), 0, false);
+}
+
 /**
  * @brief Submit sqes acquired from io_uring_get_sqe() to the kernel.
  *
@@ -398,7 +490,7 @@ void uring<uring_flags>::append_sq_entry(const sq_entry *sqe) noexcept {
  */
 template<uint64_t uring_flags>
 inline int uring<uring_flags>::wait_sq_ring() {
-    if constexpr (!(uring_flags & IORING_SETUP_SQPOLL)) {
+    if (!sq.template is_sqpoll<uring_flags>()) {
         return 0;
     }
     if (sq_space_left()) {
@@ -591,12 +683,117 @@ int uring<uring_flags>::unregister_ring_fd() {
     return ret;
 }
 
+template<uint64_t uring_flags>
+int uring<uring_flags>::register_buffers(
+    const iovec *iovecs, unsigned nr
+) noexcept {
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 13)
+    struct io_uring_rsrc_register reg = {
+        .nr = nr,
+        .flags = 0,
+        .resv2 = 0,
+        .data = (uint64_t)iovecs,
+        .tags = 0,
+    };
+
+    const int ret = __sys_io_uring_register(
+        this->ring_fd, IORING_REGISTER_BUFFERS2, &reg, sizeof(reg)
+    );
+#else
+    const int ret = __sys_io_uring_register(
+        this->ring_fd, IORING_REGISTER_BUFFERS, iovecs, nr
+    );
+#endif
+    return ret < 0 ? ret : 0;
+}
+
+template<uint64_t uring_flags>
+int uring<uring_flags>::unregister_buffers() noexcept {
+    const int ret = __sys_io_uring_register(
+        this->ring_fd, IORING_UNREGISTER_BUFFERS, nullptr, 0
+    );
+    return ret < 0 ? ret : 0;
+}
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
+template<uint64_t uring_flags>
+int uring<uring_flags>::register_files_sparse(unsigned nr) noexcept {
+    struct io_uring_rsrc_register reg = {
+        .nr = nr,
+        .flags = IORING_RSRC_REGISTER_SPARSE,
+        .resv2 = 0,
+        .data = 0,
+        .tags = 0,
+    };
+
+    const int ret = __sys_io_uring_register(
+        this->ring_fd, IORING_REGISTER_FILES2, &reg, sizeof(reg)
+    );
+    return ret < 0 ? ret : 0;
+}
+#endif
+
+template<uint64_t uring_flags>
+int uring<uring_flags>::unregister_files() noexcept {
+    const int ret = __sys_io_uring_register(
+        this->ring_fd, IORING_UNREGISTER_FILES, nullptr, 0
+    );
+    return ret < 0 ? ret : 0;
+}
+
+template<uint64_t uring_flags>
+int uring<uring_flags>::register_probe(
+    io_uring_probe *probe, unsigned nr_ops
+) noexcept {
+    const int ret = __sys_io_uring_register(
+        this->ring_fd, IORING_REGISTER_PROBE, probe, nr_ops
+    );
+    return ret < 0 ? ret : 0;
+}
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
+template<uint64_t uring_flags>
+int uring<uring_flags>::register_buf_ring(
+    buf_ring *br, unsigned entries, uint16_t bgid
+) noexcept {
+    struct io_uring_buf_reg reg = {
+        .ring_addr = (uint64_t)br,
+        .ring_entries = entries,
+        .bgid = bgid,
+        .flags = 0,
+        .resv = {},
+    };
+
+    const int ret = __sys_io_uring_register(
+        this->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1
+    );
+    return ret < 0 ? ret : 0;
+}
+
+template<uint64_t uring_flags>
+int uring<uring_flags>::unregister_buf_ring(uint16_t bgid) noexcept {
+    struct io_uring_buf_reg reg = {};
+    reg.bgid = bgid;
+
+    const int ret = __sys_io_uring_register(
+        this->ring_fd, IORING_UNREGISTER_PBUF_RING, &reg, 1
+    );
+    return ret < 0 ? ret : 0;
+}
+#endif
+
 template<uint64_t uring_flags>
 void uring<uring_flags>::init(unsigned entries, params &params) {
     assert(this->ring_fd == -1 && "The uring may be inited twice.");
 
-    // override the params.flags
-    params.flags = static_cast<uint32_t>(uring_flags);
+    // uring_flags are always set, and the runtime flags are kept
+    params.flags |= static_cast<uint32_t>(uring_flags);
+    [[maybe_unused]] constexpr uint64_t layout_flags =
+        IORING_SETUP_SQE128 | IORING_SETUP_CQE32;
+    assert(
+        (params.flags & ~uring_flags & layout_flags) == 0
+        && "SQE128 and CQE32 must be given by uring_flags"
+    );
 
     const int fd = __sys_io_uring_setup(entries, &params);
     if (fd < 0) [[unlikely]] {
@@ -608,6 +805,7 @@ void uring<uring_flags>::init(unsigned entries, params &params) {
     std::memset(this, 0, sizeof(*this)); // NOLINT
 
     this->ring_fd = this->enter_ring_fd = fd;
+    this->flags = this->sq.setup_flags = params.flags;
     this->features = params.features;
     this->int_flags = 0;
     try {
@@ -748,7 +946,7 @@ inline constexpr bool uring<uring_flags>::is_sq_ring_need_enter(
         return false;
     }
 
-    if constexpr (!(uring_flags & IORING_SETUP_SQPOLL)) {
+    if (!sq.template is_sqpoll<uring_flags>()) {
         return true;
     }
 
@@ -779,7 +977,7 @@ uring<uring_flags>::is_cq_ring_need_enter() const noexcept {
     if constexpr (uring_flags & IORING_SETUP_IOPOLL) {
         return true;
     } else {
-        return is_cq_ring_need_flush();
+        return (flags & IORING_SETUP_IOPOLL) || is_cq_ring_need_flush();
     }
 }
 
@@ -6,7 +6,9 @@
 #include <co_context/co/semaphore.hpp>
 #include <co_context/co/stop_token.hpp>
 #include <co_context/io_context.hpp>
+#include <co_context/io_context_pool.hpp>
 #include <co_context/lazy_io.hpp>
+#include <co_context/link_chain.hpp>
 #include <co_context/net.hpp>
 #include <co_context/shared_task.hpp>
 #include <co_context/task.hpp>
@@ -0,0 +1,255 @@
+#pragma once
+
+#include <co_context/detail/attributes.hpp>
+#include <co_context/detail/lazy_io_awaiter.hpp>
+#include <uring/buf_ring.hpp>
+#include <uring/utility/kernel_version.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
+
+namespace co_context {
+
+class buffer_group;
+
+/**
+ * @brief A buffer picked by the kernel from a buffer_group, holding the
+ * received bytes. It goes back to the group on destruction.
+ * @note Must be destructed on the thread of the io_context owning the group.
+ * Drop it before waiting for the next one, or a waiting connection holds a
+ * buffer, and the group may run dry.
+ */
+class [[nodiscard]] provided_buffer final {
+  public:
+    provided_buffer() noexcept = default;
+
+    provided_buffer(provided_buffer &&other) noexcept
+        : group(std::exchange(other.group, nullptr))
+        , buf(std::exchange(other.buf, {}))
+        , res(other.res)
+        , buf_id(other.buf_id) {}
+
+    provided_buffer &operator=(provided_buffer &&other) noexcept {
+        if (this != &other) {
+            release();
+            group = std::exchange(other.group, nullptr);
+            buf = std::exchange(other.buf, {});
+            res = other.res;
+            buf_id = other.buf_id;
+        }
+        return *this;
+    }
+
+    provided_buffer(const provided_buffer &) = delete;
+    provided_buffer &operator=(const provided_buffer &) = delete;
+
+    ~provided_buffer() noexcept { release(); }
+
+    // Bytes received, 0 on EOF, or -errno. -ENOBUFS if the group is empty.
+    [[nodiscard]]
+    int32_t result() const noexcept {
+        return res;
+    }
+
+    // true if some bytes are received.
+    explicit operator bool() const noexcept { return res > 0; }
+
+    [[nodiscard]]
+    char *data() const noexcept {
+        return buf.data();
+    }
+
+    [[nodiscard]]
+    size_t size() const noexcept {
+        return buf.size();
+    }
+
+    // The received bytes.
+    [[nodiscard]]
+    std::span<char> span() const noexcept {
+        return buf;
+    }
+
+    // Return the buffer to the group early.
+    void release() noexcept;
+
+  private:
+    friend class buffer_group;
+
+    provided_buffer(
+        buffer_group *group, std::span<char> buf, int32_t res, uint16_t buf_id
+    ) noexcept
+        : group(group)
+        , buf(buf)
+        , res(res)
+        , buf_id(buf_id) {}
+
+    buffer_group *group = nullptr;
+    std::span<char> buf;
+    int32_t res = 0;
+    uint16_t buf_id = 0;
+};
+
+namespace detail {
+    struct lazy_recv_select;
+    class recv_stream_state;
+} // namespace detail
+
+/**
+ * @brief Equal-sized buffers handed to the kernel through a provided-buffer
+ * ring. A recv on the group is given a buffer only once data arrives, so an
+ * idle connection holds no buffer.
+ * @note Not thread-safe. Construct, use and destruct it on the thread of an
+ * io_context, see io_context::set_work_stealing(). Destruct it after all its
+ * recvs complete.
+ */
+class buffer_group final {
+  public:
+    /**
+     * @param buffer_num Rounded up to a power of two, at most 32768.
+     * @throw std::system_error if the kernel rejects the buffer ring.
+     */
+    buffer_group(uint32_t buffer_num, uint32_t buffer_size);
+
+    ~buffer_group() noexcept;
+
+    buffer_group(const buffer_group &) = delete;
+    buffer_group &operator=(const buffer_group &) = delete;
+
+    /**
+     * @brief Receive into a buffer picked by the kernel.
+     * @return an awaiter whose result is a provided_buffer.
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    detail::lazy_recv_select recv(int sockfd, int flags = 0) noexcept;
+
+    // The bgid of the group.
+    [[nodiscard]]
+    uint16_t id() const noexcept {
+        return bgid;
+    }
+
+    [[nodiscard]]
+    uint32_t capacity() const noexcept {
+        return buffer_num;
+    }
+
+    [[nodiscard]]
+    uint32_t buffer_bytes() const noexcept {
+        return buffer_size;
+    }
+
+  private:
+    friend class provided_buffer;
+    friend struct detail::lazy_recv_select;
+    friend class detail::recv_stream_state;
+
+    // Take the buffer reported by a cqe.
+    [[nodiscard]]
+    provided_buffer take(int32_t res, uint32_t cqe_flags) noexcept {
+        if ((cqe_flags & IORING_CQE_F_BUFFER) == 0) {
+            return {nullptr, {}, res, 0};
+        }
+        const auto buf_id = uint16_t(cqe_flags >> IORING_CQE_BUFFER_SHIFT);
+        const size_t len = res > 0 ? size_t(res) : 0;
+        ++lent;
+        return {this, {buffer_at(buf_id), len}, res, buf_id};
+    }
+
+    [[nodiscard]]
+    char *buffer_at(uint16_t buf_id) const noexcept {
+        return arena + size_t(buf_id) * buffer_size;
+    }
+
+    // Hand the buffer to the kernel again.
+    void recycle(uint16_t buf_id) noexcept {
+        assert(is_on_owner() && "a provided_buffer out of its io_context");
+        br->add(buffer_at(buf_id), buffer_size, buf_id, int(mask), 0);
+        br->advance(1);
+        --lent;
+        if (!starved.empty()) [[unlikely]] {
+            wake_starved();
+        }
+    }
+
+    // Arm again the streams parked on -ENOBUFS.
+    void wake_starved() noexcept;
+
+    // Whether a buffer is back since the kernel ran out, so that a stream
+    // needs not park.
+    [[nodiscard]]
+    bool has_buffer() const noexcept {
+        return lent < buffer_num;
+    }
+
+    // false on a thief of a work-stealing io_context, see set_work_stealing().
+    [[nodiscard]]
+    bool is_on_owner() const noexcept {
+        const detail::worker_meta *const worker = detail::this_thread.worker;
+        return worker != nullptr && &worker->ring == ring;
+    }
+
+    detail::uring *ring;
+    liburingcxx::buf_ring *br;
+    size_t ring_size;
+    char *arena;
+    size_t arena_size;
+    uint32_t buffer_num;
+    uint32_t buffer_size;
+    uint32_t mask;
+    uint16_t bgid;
+    // buffers taken from the kernel, not recycled yet
+    uint32_t lent = 0;
+    // streams waiting for a buffer to be back
+    std::vector<detail::recv_stream_state *> starved;
+};
+
+inline void provided_buffer::release() noexcept {
+    if (group != nullptr) {
+        group->recycle(buf_id);
+        group = nullptr;
+        buf = {};
+    }
+}
+
+namespace detail {
+
+    struct lazy_recv_select : lazy_awaiter {
+        inline lazy_recv_select(
+            buffer_group &group, int sockfd, int flags
+        ) noexcept
+            : group(group) {
+            assert(group.is_on_owner() && "a buffer_group out of its io_context");
+            sqe->prep_recv_select(
+                sockfd, group.buffer_bytes(), flags, group.id()
+            );
+        }
+
+        provided_buffer await_resume() noexcept {
+            record_in_queue();
+            return group.take(
+                io_info.result,
+                io_info.cqe_flags | (uint32_t(io_info.buf_id)
+                                     << IORING_CQE_BUFFER_SHIFT)
+            );
+        }
+
+        buffer_group &group;
+    };
+
+} // namespace detail
+
+inline detail::lazy_recv_select
+buffer_group::recv(int sockfd, int flags) noexcept {
+    return detail::lazy_recv_select{*this, sockfd, flags};
+}
+
+} // namespace co_context
+
+#endif
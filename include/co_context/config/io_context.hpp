@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <bit>
 #include <cstddef>
 #include <cstdint>
@@ -21,14 +22,15 @@ inline constexpr size_t cache_line_size = 64;
 // ========================================================================
 
 // ====================== Thread model configuration ======================
-// At most 255 threads/io_contexts.
-using ctx_id_t = uint8_t;
+// At most 65535 io_contexts alive at the same time. Ids are reused.
+using ctx_id_t = uint16_t;
 
 inline constexpr bool is_using_hyper_threading = true;
 // ========================================================================
 
 // ======================= io_context configuration =======================
 using cur_t = uint32_t;
+// Defaults of io_context_options::swap_capacity and io_uring_entries.
 // inline constexpr cur_t swap_capacity = 4;
 // inline constexpr cur_t swap_capacity = 8;
 // inline constexpr cur_t swap_capacity = 16;
@@ -49,7 +51,8 @@ inline constexpr uint32_t default_io_uring_entries =
     std::bit_ceil<uint32_t>(swap_capacity * 2ULL);
 
 /**
- * @brief Maximal batch size of submissions. -1 means the batch size is
+ * @brief Default maximal batch size of submissions, see
+ * `io_context_options::submit_batch_max`. -1 means the batch size is
  * unlimited.
  * @note Once the threshold is reached, it is not mandatary to submit to
  * io_uring immediately. As a result, the actual batch size might be equal
@@ -57,6 +60,82 @@ inline constexpr uint32_t default_io_uring_entries =
  */
 // inline constexpr uint32_t submission_threshold = 32;
 inline constexpr uint32_t submission_threshold = -1U;
+
+/**
+ * @brief Capacity of the lock-free queue receiving coroutines from other
+ * threads, when eventfd (instead of msg_ring) is used. Coroutines beyond it
+ * fall back to a locked queue.
+ */
+inline constexpr uint32_t co_spawn_queue_capacity = 1024;
+
+/**
+ * @brief Capacity of the channel from an io_context to another, which batches
+ * the coroutines sent by msg_ring. A channel starts small, and grows by four
+ * times once full, up to `msg_ring_batch_capacity`. Coroutines beyond it are
+ * sent one by one.
+ */
+inline constexpr cur_t msg_ring_batch_initial_capacity = 16;
+inline constexpr cur_t msg_ring_batch_capacity = 1024;
+static_assert(std::has_single_bit(msg_ring_batch_initial_capacity));
+static_assert(std::has_single_bit(msg_ring_batch_capacity));
+static_assert(msg_ring_batch_initial_capacity <= msg_ring_batch_capacity);
+// ========================================================================
+
+// ====================== work-stealing configuration =====================
+/**
+ * @brief In work-stealing mode, an io_context starts sharing its ready
+ * coroutines with idle peers once more than this number are waiting.
+ */
+inline constexpr cur_t work_stealing_threshold = 64;
+
+/**
+ * @brief Maximal number of coroutines moved by a single share/steal.
+ * @note The swap_capacity of a work-stealing io_context must be at least
+ * twice this, which is checked when it starts.
+ */
+inline constexpr cur_t work_stealing_batch = 256;
+static_assert(work_stealing_batch <= swap_capacity / 2);
+// ========================================================================
+
+// ======================== priority configuration ========================
+/**
+ * @brief Weights of the priority lanes {high, normal, low}, i.e. at most how
+ * many coroutines are resumed from each lane in a round of weighted
+ * round-robin.
+ * @note A new round begins only when no ready lane has weight left, so that a
+ * lower lane waits for at most one round of the higher ones.
+ */
+inline constexpr std::array<uint32_t, 3> priority_weights = {16, 4, 1};
+
+/**
+ * @brief The ring of the high and low lanes is `swap_capacity` divided by
+ * this. A busier lane spills instead of failing.
+ */
+inline constexpr uint32_t minor_lane_capacity_divisor = 8;
+static_assert(minor_lane_capacity_divisor != 0);
+// ========================================================================
+
+// ========================= trace configuration ==========================
+/**
+ * @brief Capacity of the trace buffer of each io_context, in records. Records
+ * beyond it are dropped until the flusher catches up. Only used with the
+ * cmake option ENABLE_TRACE.
+ */
+inline constexpr uint32_t trace_buffer_capacity = 65536;
+// ========================================================================
+
+// ======================= frame pool configuration =======================
+/**
+ * @brief Allocate the frames of task<> and shared_task<> from a per-thread
+ * pool, instead of the global operator new.
+ */
+inline constexpr bool is_using_frame_pool = true;
+
+/**
+ * @brief At most this number of free frames are cached per size class and
+ * per thread. The rest go back to the global operator delete.
+ */
+inline constexpr uint32_t frame_pool_cache_limit = 1024;
 // ========================================================================
 
 // =========================== co configuration ===========================
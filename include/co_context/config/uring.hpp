@@ -6,6 +6,11 @@
 
 namespace co_context::config {
 
+/**
+ * @brief Flags of io_uring_setup that every io_context uses. The checks of
+ * SQPOLL are folded at compile time if it is set here.
+ * @note More flags can be chosen per io_context, see `io_context_options`.
+ */
 inline constexpr unsigned io_uring_setup_flags = 0;
 // inline constexpr unsigned io_uring_setup_flags = IORING_SETUP_SQPOLL;
 
@@ -22,6 +27,30 @@ inline constexpr unsigned io_uring_coop_taskrun_flag =
 
 inline constexpr uint64_t uring_setup_flags = 0;
 
+/**
+ * @brief Default runtime flags of io_uring_setup, used by
+ * `io_context_options`. The kernel may still reject them, and then they are
+ * dropped one by one.
+ */
+inline constexpr unsigned default_io_uring_setup_flags =
+    0
+#if LIBURINGCXX_IS_KERNEL_REACH(6, 0)
+    | IORING_SETUP_SINGLE_ISSUER
+#endif
+#if LIBURINGCXX_IS_KERNEL_REACH(6, 1)
+    // DEFER_TASKRUN does not work with SQPOLL
+    | (bool(io_uring_setup_flags & IORING_SETUP_SQPOLL)
+           ? 0
+           : IORING_SETUP_DEFER_TASKRUN)
+#endif
+    ;
+
+/**
+ * @brief If `IORING_SETUP_COOP_TASKRUN` and `IORING_SETUP_TASKRUN_FLAG` are
+ * enabled by default. They are ignored under SQPOLL.
+ */
+inline constexpr bool default_coop_taskrun = LIBURINGCXX_IS_KERNEL_REACH(5, 19);
+
 /**
  * @brief Use msg_ring to co_spawn betweens io_contexts, instead of
  * eventfd, std::mutex and std::queue.
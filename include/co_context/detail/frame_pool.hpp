@@ -0,0 +1,195 @@
+#pragma once
+
+#include <co_context/config/io_context.hpp>
+#include <co_context/detail/attributes.hpp>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace co_context::detail {
+
+/**
+ * @brief A per-thread pool of coroutine frames, in power-of-two size classes.
+ * A frame freed by the thread allocating it goes back to a local free list.
+ * A frame freed by another thread is pushed to the owner's lock-free stack,
+ * which the owner reclaims when its free list runs dry.
+ * @note A pool outlives its thread, so that a frame can always be returned.
+ * It is adopted by the next thread asking for a pool.
+ */
+class frame_pool final {
+  public:
+    struct stats {
+        // frames allocated from the free list
+        uint64_t hit_count = 0;
+        // frames allocated by the global operator new
+        uint64_t miss_count = 0;
+        // frames returned by other threads
+        uint64_t remote_free_count = 0;
+        // frames too large for any size class
+        uint64_t oversize_count = 0;
+    };
+
+    static constexpr size_t header_size = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+    static constexpr uint32_t min_class_bits = 7; // 128 bytes
+    static constexpr uint32_t class_num = 6;
+    static constexpr size_t max_block_size = size_t(1)
+                                             << (min_class_bits + class_num - 1);
+
+    [[nodiscard]]
+    static void *allocate(size_t size) {
+        if constexpr (!config::is_using_frame_pool) {
+            return ::operator new(size);
+        }
+        frame_pool &pool = local();
+        if (size + header_size > max_block_size) [[unlikely]] {
+            ++pool.counters.oversize_count;
+            return ::operator new(size);
+        }
+        return pool.allocate_block(class_of(size + header_size));
+    }
+
+    static void deallocate(void *ptr, size_t size) noexcept {
+        if constexpr (!config::is_using_frame_pool) {
+            ::operator delete(ptr, size);
+            return;
+        }
+        if (size + header_size > max_block_size) [[unlikely]] {
+            ::operator delete(ptr, size);
+            return;
+        }
+        block_header *const header = header_of(ptr);
+        frame_pool *const owner = header->owner;
+        if (owner == local_pool) [[likely]] {
+            owner->free_local(header);
+        } else {
+            owner->free_remote(header);
+        }
+    }
+
+    // The pool of this thread.
+    [[nodiscard]]
+    static frame_pool &local() {
+        if (local_pool != nullptr) [[likely]] {
+            return *local_pool;
+        }
+        return acquire_local();
+    }
+
+    [[nodiscard]]
+    const stats &get_stats() const noexcept {
+        return counters;
+    }
+
+  private:
+    struct block_header {
+        frame_pool *owner;
+        uint32_t size_class;
+    };
+
+    static_assert(sizeof(block_header) <= header_size);
+
+    // Stored right after the header of a free block.
+    struct free_block {
+        free_block *next;
+    };
+
+    [[nodiscard]]
+    static uint32_t class_of(size_t block_size) noexcept {
+        const auto bits = uint32_t(std::bit_width(block_size - 1));
+        return bits > min_class_bits ? bits - min_class_bits : 0;
+    }
+
+    [[nodiscard]]
+    static size_t size_of(uint32_t size_class) noexcept {
+        return size_t(1) << (min_class_bits + size_class);
+    }
+
+    [[nodiscard]]
+    static block_header *header_of(void *ptr) noexcept {
+        return reinterpret_cast<block_header *>(
+            static_cast<std::byte *>(ptr) - header_size
+        );
+    }
+
+    [[nodiscard]]
+    static void *payload_of(block_header *header) noexcept {
+        return reinterpret_cast<std::byte *>(header) + header_size;
+    }
+
+    [[nodiscard]]
+    static block_header *header_of(free_block *block) noexcept {
+        return header_of(static_cast<void *>(block));
+    }
+
+    [[nodiscard]]
+    void *allocate_block(uint32_t size_class) {
+        free_block *block = free_lists[size_class];
+        if (block == nullptr) [[unlikely]] {
+            reclaim_remote();
+            block = free_lists[size_class];
+            if (block == nullptr) {
+                ++counters.miss_count;
+                auto *header = static_cast<block_header *>(
+                    ::operator new(size_of(size_class))
+                );
+                header->owner = this;
+                header->size_class = size_class;
+                return payload_of(header);
+            }
+        }
+        ++counters.hit_count;
+        free_lists[size_class] = block->next;
+        --free_sizes[size_class];
+        return block;
+    }
+
+    void free_local(block_header *header) noexcept {
+        const uint32_t size_class = header->size_class;
+        if (free_sizes[size_class] >= config::frame_pool_cache_limit)
+            [[unlikely]] {
+            ::operator delete(header, size_of(size_class));
+            return;
+        }
+        auto *block = static_cast<free_block *>(payload_of(header));
+        block->next = free_lists[size_class];
+        free_lists[size_class] = block;
+        ++free_sizes[size_class];
+    }
+
+    // Called by any thread except the owner.
+    void free_remote(block_header *header) noexcept {
+        auto *block = static_cast<free_block *>(payload_of(header));
+        block->next = remote_frees.load(std::memory_order_relaxed);
+        while (!remote_frees.compare_exchange_weak(
+            block->next, block, std::memory_order_release,
+            std::memory_order_relaxed
+        )) {}
+    }
+
+    // Move the frames returned by other threads to the free lists.
+    void reclaim_remote() noexcept;
+
+    [[CO_CONTEXT_NOINLINE]]
+    static frame_pool &acquire_local();
+
+    // Called on the exit of the owner thread.
+    static void abandon_local() noexcept;
+
+    friend struct frame_pool_releaser;
+
+    static inline thread_local frame_pool *local_pool = nullptr;
+
+    std::array<free_block *, class_num> free_lists{};
+    std::array<uint32_t, class_num> free_sizes{};
+    stats counters;
+
+    alignas(config::cache_line_size) std::atomic<free_block *> remote_frees{
+        nullptr
+    };
+};
+
+} // namespace co_context::detail
@@ -1,9 +1,15 @@
 #pragma once
 
 #include <co_context/config/io_context.hpp>
+#include <co_context/log/log.hpp>
 
-#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 // Friend classes of io_context:
 namespace co_context {
@@ -20,11 +26,56 @@ namespace detail {
 
 namespace co_context::detail {
 
+struct worker_meta;
+
+inline constexpr size_t ctx_id_space = size_t(config::ctx_id_t(-1)) + 1;
+
+// `ctx_id_t(-1)` stands for no io_context.
+inline constexpr size_t max_ctx_num = ctx_id_space - 1;
+
+/**
+ * @brief The registry of io_contexts. An io_context may join (construct) or
+ * leave (destruct) at any time, without waiting for the others.
+ */
 struct io_context_meta_type {
     std::mutex mtx;
-    std::condition_variable cv;
-    config::ctx_id_t create_count; // Do not initialize this
-    config::ctx_id_t ready_count;  // Do not initialize this
+    uint32_t create_count; // Do not initialize this
+    // ids released by destructed io_contexts, reused first
+    std::vector<config::ctx_id_t> free_ids;
+
+    // number of running io_contexts
+    std::atomic<uint32_t> ready_count; // Do not initialize this
+
+    // Increased each time a worker starts, telling apart the workers reusing
+    // the same id.
+    std::atomic<uint64_t> generation_count;
+
+    // Workers in work-stealing mode. Slots are reused under `mtx`, read by
+    // thieves once `steal_peer_num` is not 0. Allocated by the first one, so
+    // that a process without work stealing does not pay for ctx_id_space
+    // slots.
+    std::unique_ptr<std::atomic<worker_meta *>[]> steal_peers;
+    std::atomic<uint32_t> steal_peer_num;
+
+    [[nodiscard]]
+    config::ctx_id_t acquire_id() noexcept {
+        std::lock_guard lg{mtx};
+        if (!free_ids.empty()) {
+            const config::ctx_id_t id = free_ids.back();
+            free_ids.pop_back();
+            return id;
+        }
+        if (create_count == max_ctx_num) [[unlikely]] {
+            log::e("Too many io_contexts. At most %zu\n", max_ctx_num);
+            std::terminate();
+        }
+        return config::ctx_id_t(create_count++);
+    }
+
+    void release_id(config::ctx_id_t id) noexcept {
+        std::lock_guard lg{mtx};
+        free_ids.push_back(id);
+    }
 };
 
 inline io_context_meta_type io_context_meta;
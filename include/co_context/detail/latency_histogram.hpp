@@ -0,0 +1,182 @@
+#pragma once
+
+#include <uring/io_uring.h>
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+namespace co_context::detail {
+
+[[nodiscard]]
+inline uint64_t latency_clock_ns() noexcept {
+    using clock = std::chrono::steady_clock;
+    return uint64_t(clock::now().time_since_epoch().count());
+}
+
+/**
+ * @brief A histogram of nanoseconds with log-linear buckets, like HdrHistogram.
+ * Each power of two is split into `sub_count` buckets, so the relative error
+ * is at most 1/sub_count.
+ * @note Not thread-safe. Written by the host thread of an io_context.
+ */
+class latency_histogram final {
+  public:
+    static constexpr uint32_t sub_bits = 3;
+    static constexpr uint32_t sub_count = 1U << sub_bits;
+    // Values beyond 2^max_bits ns (about 18 minutes) fall in the last bucket.
+    static constexpr uint32_t max_bits = 40;
+    static constexpr uint32_t bucket_num =
+        (max_bits - sub_bits + 1) * sub_count;
+
+    void record(uint64_t ns) noexcept {
+        ++buckets[bucket_of(ns)];
+        ++total;
+        sum += ns;
+        if (ns > max_ns) {
+            max_ns = ns;
+        }
+    }
+
+    [[nodiscard]]
+    uint64_t count() const noexcept {
+        return total;
+    }
+
+    [[nodiscard]]
+    uint64_t max() const noexcept {
+        return max_ns;
+    }
+
+    [[nodiscard]]
+    uint64_t mean() const noexcept {
+        return total ? sum / total : 0;
+    }
+
+    /**
+     * @brief The lower bound of the bucket holding the given quantile.
+     * @param quantile in [0, 1], e.g. 0.99
+     */
+    [[nodiscard]]
+    uint64_t value_at(double quantile) const noexcept {
+        if (total == 0) {
+            return 0;
+        }
+        auto rank = uint64_t(quantile * double(total));
+        rank = rank < total ? rank : total - 1;
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < bucket_num; ++i) {
+            seen += buckets[i];
+            if (seen > rank) {
+                return lower_bound_of(i);
+            }
+        }
+        return max_ns;
+    }
+
+    // f(lower_bound_ns, count) for each non-empty bucket.
+    template<typename F>
+    void for_each_bucket(F &&f) const {
+        for (uint32_t i = 0; i < bucket_num; ++i) {
+            if (buckets[i] != 0) {
+                f(lower_bound_of(i), buckets[i]);
+            }
+        }
+    }
+
+    [[nodiscard]]
+    static constexpr uint32_t bucket_of(uint64_t ns) noexcept {
+        constexpr uint64_t limit = (uint64_t(1) << max_bits) - 1;
+        ns = ns < limit ? ns : limit;
+        if (ns < sub_count) {
+            return uint32_t(ns);
+        }
+        const uint32_t exp = uint32_t(std::bit_width(ns)) - 1;
+        const uint32_t mantissa =
+            uint32_t(ns >> (exp - sub_bits)) & (sub_count - 1);
+        return (exp - sub_bits + 1) * sub_count + mantissa;
+    }
+
+    [[nodiscard]]
+    static constexpr uint64_t lower_bound_of(uint32_t bucket) noexcept {
+        if (bucket < sub_count) {
+            return bucket;
+        }
+        const uint32_t group = bucket / sub_count;
+        const uint32_t mantissa = bucket % sub_count;
+        return uint64_t(sub_count + mantissa) << (group - 1);
+    }
+
+  private:
+    std::array<uint64_t, bucket_num> buckets{};
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t max_ns = 0;
+};
+
+static_assert(latency_histogram::bucket_of(7) == 7);
+static_assert(latency_histogram::lower_bound_of(
+                  latency_histogram::bucket_of(1000)
+              ) <= 1000);
+static_assert(
+    latency_histogram::bucket_of(~uint64_t(0)) < latency_histogram::bucket_num
+);
+
+/**
+ * @brief Latency histograms of an io_context, per opcode of io_uring.
+ */
+class latency_stats final {
+  public:
+    struct op_latency {
+        // from the construction of a lazy_io to its completion
+        latency_histogram in_flight;
+        // from the completion to the resumption of the coroutine
+        latency_histogram in_queue;
+    };
+
+    static constexpr uint32_t op_num = IORING_OP_LAST;
+
+    void record_in_flight(uint8_t opcode, uint64_t ns) {
+        if (opcode < op_num) [[likely]] {
+            at(opcode).in_flight.record(ns);
+        }
+    }
+
+    void record_in_queue(uint8_t opcode, uint64_t ns) {
+        if (opcode < op_num) [[likely]] {
+            at(opcode).in_queue.record(ns);
+        }
+    }
+
+    // nullptr if no operation of the opcode has completed.
+    [[nodiscard]]
+    const op_latency *find(uint8_t opcode) const noexcept {
+        return opcode < op_num ? ops[opcode].get() : nullptr;
+    }
+
+    [[nodiscard]]
+    static const char *op_name(uint8_t opcode) noexcept;
+
+    /**
+     * @brief Print count, mean, p50, p99, p999 and max of each opcode, in
+     * microseconds.
+     */
+    void dump(std::FILE *out) const;
+
+  private:
+    op_latency &at(uint8_t opcode) {
+        auto &op = ops[opcode];
+        if (op == nullptr) [[unlikely]] {
+            op = std::make_unique<op_latency>();
+        }
+        return *op;
+    }
+
+    // allocated on the first completion of each opcode
+    std::array<std::unique_ptr<op_latency>, op_num> ops;
+};
+
+} // namespace co_context::detail
@@ -8,10 +8,16 @@
 
 #include <cassert>
 #include <chrono>
+#include <concepts>
 #include <coroutine>
 #include <cstdint>
 #include <span>
 #include <type_traits>
+#include <utility>
+
+namespace co_context {
+class link_chain;
+} // namespace co_context
 
 namespace co_context::detail {
 
@@ -36,6 +42,8 @@ class lazy_awaiter {
 
     void await_suspend(std::coroutine_handle<> current) noexcept {
         io_info.handle = current;
+        stamp_opcode();
+        trace(trace_event::suspend_io, current, sqe->get_opcode());
     }
 
     lazy_awaiter &set_async() & noexcept {
@@ -48,7 +56,14 @@ class lazy_awaiter {
         return std::move(*this);
     }
 
-    /*NOLINT*/ int32_t await_resume() const noexcept { return result(); }
+    /*NOLINT*/ int32_t await_resume() const noexcept {
+        record_in_queue();
+        return result();
+    }
+
+    // Whether the sqe and the result are all the state of the awaiter, so
+    // that a link_chain may take it over.
+    static constexpr bool is_plain = true;
 
     std::suspend_never detach() && noexcept {
 #if LIBURINGCXX_IS_KERNEL_REACH(5, 17)
@@ -69,6 +84,7 @@ class lazy_awaiter {
   protected:
     friend struct lazy_link_io;
     friend struct lazy_link_timeout;
+    friend class co_context::link_chain;
     liburingcxx::sq_entry *sqe;
     task_info io_info;
 
@@ -86,7 +102,28 @@ class lazy_awaiter {
 
     friend void set_link_awaiter(lazy_awaiter &awaiter) noexcept;
 
+    // Remember the opcode once the sqe is prepared.
+    void stamp_opcode() noexcept {
+#if CO_CONTEXT_USE_LATENCY_HISTOGRAM
+        io_info.opcode = sqe->get_opcode();
+#endif
+    }
+
+    // Count the time from the completion to the resumption.
+    void record_in_queue() const {
+#if CO_CONTEXT_USE_LATENCY_HISTOGRAM
+        this_thread.worker->latency.record_in_queue(
+            io_info.opcode, latency_clock_ns() - io_info.complete_ns
+        );
+#endif
+    }
+
     lazy_awaiter() noexcept : sqe(this_thread.worker->get_free_sqe()) {
+        io_info.prio = this_thread.worker->current_priority;
+#if CO_CONTEXT_USE_LATENCY_HISTOGRAM
+        io_info.opcode = IORING_OP_LAST;
+        io_info.submit_ns = latency_clock_ns();
+#endif
         sqe->set_data(
             io_info.as_user_data() | uint64_t(user_data_type::task_info_ptr)
         );
@@ -102,6 +139,28 @@ class lazy_awaiter {
 #endif
 };
 
+/**
+ * @brief The I/O of `Awaiter` on a direct descriptor, i.e. its fd is a slot
+ * of the file table registered to the ring.
+ */
+template<std::derived_from<lazy_awaiter> Awaiter>
+struct lazy_direct : Awaiter {
+    template<typename... Args>
+    inline explicit lazy_direct(Args &&...args) noexcept
+        : Awaiter(std::forward<Args>(args)...) {
+        this->sqe->set_fixed_file();
+    }
+};
+
+/**
+ * @brief A lazy_awaiter with no state of its own, nor its own user_data or
+ * await_resume(), which is lost once a link_chain takes it over.
+ */
+template<typename Awaiter>
+concept plain_awaiter = std::derived_from<Awaiter, lazy_awaiter>
+                        && sizeof(Awaiter) == sizeof(lazy_awaiter)
+                        && Awaiter::is_plain;
+
 inline void set_link_sqe(liburingcxx::sq_entry *sqe) noexcept {
     sqe->set_link();
     sqe->fetch_data() |= uint64_t(user_data_type::task_info_ptr__link_sqe);
@@ -109,6 +168,7 @@ inline void set_link_sqe(liburingcxx::sq_entry *sqe) noexcept {
 
 inline void set_link_awaiter(lazy_awaiter &awaiter) noexcept {
     set_link_sqe(awaiter.sqe);
+    awaiter.stamp_opcode();
 }
 
 inline void set_link_link_io(lazy_link_io &link_io) noexcept {
@@ -137,9 +197,12 @@ operator&&(lazy_link_io &&lhs, lazy_link_io &&rhs) noexcept {
 inline void lazy_link_io::await_suspend(std::coroutine_handle<> current
 ) const noexcept {
     this->last_io->io_info.handle = current;
+    this->last_io->stamp_opcode();
+    trace(trace_event::suspend_io, current, this->last_io->sqe->get_opcode());
 }
 
 inline int32_t lazy_link_io::await_resume() const noexcept {
+    this->last_io->record_in_queue();
     return this->last_io->io_info.result;
 }
 
@@ -401,6 +464,14 @@ struct lazy_accept_direct : lazy_awaiter {
     }
 };
 
+struct lazy_accept_direct_alloc : lazy_awaiter {
+    inline lazy_accept_direct_alloc(
+        int fd, sockaddr *addr, socklen_t *addrlen, int flags
+    ) noexcept {
+        sqe->prep_accept_direct_alloc(fd, addr, addrlen, flags);
+    }
+};
+
 #if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
 struct lazy_multishot_accept : lazy_awaiter {
     inline lazy_multishot_accept(
@@ -858,8 +929,7 @@ struct lazy_yield {
     static constexpr bool await_ready() noexcept { return false; }
 
     static void await_suspend(std::coroutine_handle<> current) noexcept {
-        auto &worker = *detail::this_thread.worker;
-        worker.co_spawn_unsafe(current);
+        detail::this_thread.worker->forward_task(current);
     }
 
     constexpr void await_resume() const noexcept {}
@@ -887,6 +957,23 @@ struct lazy_who_am_i {
 
 using lazy_forget = std::suspend_always;
 
+struct lazy_set_priority {
+    // Changes the lane of the running coroutine without suspending it.
+    bool await_ready() const noexcept {
+        priority &current = this_thread.worker->current_priority;
+        current = has_pin(current) ? with_pin(prio) : prio;
+        return true;
+    }
+
+    constexpr void await_suspend(std::coroutine_handle<>) const noexcept {}
+
+    constexpr void await_resume() const noexcept {}
+
+    explicit lazy_set_priority(priority prio) noexcept : prio(prio) {}
+
+    priority prio;
+};
+
 class lazy_resume_on {
   public:
     static constexpr bool await_ready() noexcept { return false; }
@@ -896,6 +983,11 @@ class lazy_resume_on {
             resume_ctx->worker.co_spawn_auto(current);
             return true;
         }
+        // Already here, so pin it as a move would.
+        worker_meta &worker = resume_ctx->worker;
+        if (worker.is_work_stealing) {
+            worker.current_priority = with_pin(worker.current_priority);
+        }
         return false;
     }
 
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <co_context/config/io_context.hpp>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+namespace co_context::detail {
+
+/**
+ * @brief A bounded lock-free multi-producer single-consumer FIFO, based on
+ * Dmitry Vyukov's bounded MPMC queue. Each cell carries a sequence number,
+ * which tells whether it is free for the producer at the same lap, or ready
+ * for the consumer.
+ */
+template<typename T, uint32_t capacity>
+class mpsc_queue final {
+    static_assert(std::has_single_bit(capacity));
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+  public:
+    mpsc_queue() noexcept {
+        for (uint32_t i = 0; i < capacity; ++i) {
+            cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Called by any producer.
+     * @return false if the queue is full.
+     */
+    [[nodiscard]]
+    bool try_push(const T &value) noexcept {
+        uint32_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            cell &c = cells[pos & mask];
+            const uint32_t seq = c.seq.load(std::memory_order_acquire);
+            const auto diff = int32_t(seq - pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed
+                    )) {
+                    c.data = value;
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Called by the only consumer.
+     * @return false if the queue is empty, or the oldest cell is still being
+     * written by a producer.
+     */
+    [[nodiscard]]
+    bool try_pop(T &value) noexcept {
+        cell &c = cells[head & mask];
+        const uint32_t seq = c.seq.load(std::memory_order_acquire);
+        if (int32_t(seq - (head + 1)) < 0) {
+            return false;
+        }
+        value = c.data;
+        c.seq.store(head + capacity, std::memory_order_release);
+        ++head;
+        return true;
+    }
+
+  private:
+    static constexpr uint32_t mask = capacity - 1;
+
+    struct cell {
+        std::atomic<uint32_t> seq;
+        T data;
+    };
+
+    alignas(config::cache_line_size) std::atomic<uint32_t> tail{0};
+    alignas(config::cache_line_size) uint32_t head = 0;
+    alignas(config::cache_line_size) std::array<cell, capacity> cells;
+};
+
+} // namespace co_context::detail
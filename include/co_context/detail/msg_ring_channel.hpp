@@ -0,0 +1,93 @@
+#pragma once
+
+#include <co_context/config/io_context.hpp>
+#include <co_context/detail/priority.hpp>
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace co_context::detail {
+
+/**
+ * @brief Coroutines sent from one io_context to another. The sender pushes
+ * them during do_worker_part(), and notifies the receiver by a single
+ * msg_ring carrying the address of this channel.
+ * @note Owned by the receiver, so that it outlives the sender. A sender
+ * constructed later with the same ctx_id takes it over. A full channel is
+ * replaced by a larger one, and the receiver keeps the old one, which is
+ * drained on its pending notification.
+ */
+struct alignas(config::cache_line_size) msg_ring_channel final {
+    using cur_t = config::cur_t;
+    using item = std::pair<std::coroutine_handle<>, priority>;
+
+    msg_ring_channel(int target_ring_fd, cur_t capacity)
+        : target_ring_fd(target_ring_fd)
+        , mask(capacity - 1)
+        , items(std::make_unique<item[]>(capacity)) {
+        assert(std::has_single_bit(capacity));
+    }
+
+    [[nodiscard]]
+    cur_t capacity() const noexcept {
+        return mask + 1;
+    }
+
+    // Called by the sender. Return false if the channel is full.
+    [[nodiscard]]
+    bool try_push(std::coroutine_handle<> handle, priority prio) noexcept {
+        const cur_t h = head.load(std::memory_order_acquire);
+        const cur_t t = tail.load(std::memory_order_relaxed);
+        if (t - h == capacity()) [[unlikely]] {
+            return false;
+        }
+        items[t & mask] = {handle, prio};
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Called by the sender. Return true if a msg_ring is needed, i.e.
+     * the receiver has not been notified since its last drain.
+     */
+    [[nodiscard]]
+    bool mark_notified() noexcept {
+        return !is_notified.exchange(true, std::memory_order_acq_rel);
+    }
+
+    /**
+     * @brief Called by the receiver, on the msg_ring cqe.
+     * @note `is_notified` is reset before draining, so that an item pushed
+     * after the drain will be notified again.
+     */
+    template<typename F>
+    void drain(F &&f) noexcept {
+        is_notified.exchange(false, std::memory_order_acq_rel);
+        cur_t h = head.load(std::memory_order_relaxed);
+        while (h != tail.load(std::memory_order_acquire)) {
+            const item it = items[h & mask];
+            head.store(++h, std::memory_order_release);
+            f(it.first, it.second);
+        }
+    }
+
+    // the ring of the receiver
+    const int target_ring_fd;
+
+    // if the channel is waiting in the sender's list to be notified
+    bool is_dirty = false;
+
+  private:
+    std::atomic_bool is_notified{false};
+    const cur_t mask;
+    const std::unique_ptr<item[]> items;
+    alignas(config::cache_line_size) std::atomic<cur_t> head{0};
+    alignas(config::cache_line_size) std::atomic<cur_t> tail{0};
+};
+
+} // namespace co_context::detail
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <co_context/detail/priority.hpp>
+#include <co_context/detail/thread_meta.hpp>
+#include <co_context/detail/user_data.hpp>
+#include <uring/sq_entry.hpp>
+
+#include <cassert>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+
+namespace co_context::detail {
+
+// A completion of a multishot request.
+struct multishot_cqe {
+    int32_t res;
+    uint32_t flags;
+};
+
+/**
+ * @brief The state of a multishot request, shared by the ring and a stream.
+ * Each cqe is queued until the stream asks for the next one. Once the
+ * kernel ends the request, it is armed again by the next await, unless the
+ * stream is finished by the cqe.
+ * @note Owned by the thread of the io_context constructing it, since the
+ * request lives in the ring of that io_context. If the stream is destructed
+ * while the request is armed, the state cancels the request and deletes
+ * itself on the last cqe.
+ */
+class multishot_state {
+  public:
+    multishot_state() noexcept : owner(this_thread.worker) {
+        assert(owner != nullptr);
+    }
+
+    multishot_state(const multishot_state &) = delete;
+    multishot_state &operator=(const multishot_state &) = delete;
+
+    virtual ~multishot_state() noexcept = default;
+
+    [[nodiscard]]
+    bool is_armed() const noexcept {
+        return armed;
+    }
+
+    // Resumable without suspension.
+    [[nodiscard]]
+    bool is_ready() const noexcept {
+        return !cqes.empty() || is_finished;
+    }
+
+    // Park the awaiting coroutine, arming the request if needed.
+    void suspend(std::coroutine_handle<> handle, priority prio) noexcept {
+        assert(is_on_owner() && "a stream used out of its io_context");
+        waiter = handle;
+        waiter_prio = prio;
+        if (!armed) {
+            arm();
+        }
+    }
+
+    /**
+     * @brief Pop the next cqe.
+     * @return the final cqe again and again, once finished.
+     */
+    [[nodiscard]]
+    multishot_cqe pop() noexcept {
+        assert(is_on_owner() && "a stream used out of its io_context");
+        if (cqes.empty()) {
+            return {final_res, 0};
+        }
+        const multishot_cqe cqe = cqes.front();
+        cqes.pop_front();
+        return cqe;
+    }
+
+    // Called by the stream on destruction. `this` may be deleted.
+    void abandon() noexcept;
+
+    // Called by handle_cq_entry(). `this` may be deleted.
+    void on_cqe(int32_t res, uint32_t flags) noexcept;
+
+    // Arm again for the waiter parked by wait_for_buffer().
+    void rearm() noexcept {
+        if (waiter && !armed) {
+            arm();
+        }
+    }
+
+  protected:
+    // Prepare the multishot request, without user_data.
+    virtual void prepare(liburingcxx::sq_entry &sqe) noexcept = 0;
+
+    // Release what the cqe carries, since nobody will take it.
+    virtual void discard(const multishot_cqe &cqe) noexcept = 0;
+
+    /**
+     * @brief On -ENOBUFS with the stream waiting, park until a buffer is back,
+     * then rearm(). Arming at once would spin while the buffers are held.
+     * @return false if the request takes no buffer, so that -ENOBUFS is an
+     * error of the stream.
+     */
+    virtual bool wait_for_buffer() noexcept { return false; }
+
+    /**
+     * @brief Whether a cqe ending the request ends the stream as well.
+     * By default, a stream ends on errors and EOF.
+     */
+    [[nodiscard]]
+    virtual bool is_final(int32_t res) const noexcept {
+        return res <= 0;
+    }
+
+  private:
+    void arm() noexcept;
+
+    // false on a thief of a work-stealing io_context, see set_work_stealing().
+    [[nodiscard]]
+    bool is_on_owner() const noexcept {
+        return owner == this_thread.worker;
+    }
+
+    [[nodiscard]]
+    uint64_t as_user_data() const noexcept {
+        return uint64_t(reinterpret_cast<uintptr_t>(this))
+               | uint64_t(user_data_type::multishot);
+    }
+
+    // The worker whose ring runs the request.
+    worker_meta *const owner;
+    std::deque<multishot_cqe> cqes;
+    std::coroutine_handle<> waiter;
+    priority waiter_prio = priority::normal;
+    int32_t final_res = 0;
+    bool armed = false;
+    bool is_finished = false;
+    bool is_abandoned = false;
+};
+
+} // namespace co_context::detail
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace co_context {
+
+/**
+ * @brief Scheduling lane of a coroutine. A coroutine keeps its priority
+ * across I/O, and passes it to the coroutines it spawns or wakes up.
+ */
+enum class priority : uint8_t { high, normal, low };
+
+inline constexpr size_t priority_num = 3;
+
+namespace detail {
+
+// Set on the priority of a coroutine that must not be stolen by another
+// worker, e.g. after `lazy::resume_on`. It is kept across I/O, but not
+// passed to the coroutines it spawns or wakes up.
+inline constexpr uint8_t pinned_bit = 0x80;
+
+[[nodiscard]]
+constexpr priority with_pin(priority prio) noexcept {
+    return priority(uint8_t(prio) | pinned_bit);
+}
+
+[[nodiscard]]
+constexpr bool has_pin(priority prio) noexcept {
+    return (uint8_t(prio) & pinned_bit) != 0;
+}
+
+// The lane of a priority, without the pin.
+[[nodiscard]]
+constexpr priority lane_of(priority prio) noexcept {
+    return priority(uint8_t(prio) & ~pinned_bit);
+}
+
+} // namespace detail
+
+} // namespace co_context
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <co_context/config/io_context.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+namespace co_context::detail {
+
+/**
+ * @brief The FIFO of ready coroutines owned by a worker.
+ * @note Coroutines go to a fixed-size ring at first. Once the ring is full,
+ * they spill into a segmented queue (std::deque), which is drained back to the
+ * ring in bulk, so that a burst costs allocations instead of a crash.
+ * @note The ring is allocated by reserve(), with a size chosen per io_context.
+ */
+class ready_queue final {
+  public:
+    using cur_t = config::cur_t;
+
+    struct stats {
+        // times that the ring size reached `warning_level()`
+        uint64_t warning_count = 0;
+        // number of coroutines pushed into the spill area
+        uint64_t overflow_count = 0;
+        // peak size of the spill area
+        uint64_t max_spill_size = 0;
+    };
+
+    /**
+     * @brief Allocate the ring, rounding `min_capacity` up to a power of two.
+     * @pre empty()
+     */
+    void reserve(cur_t min_capacity) {
+        assert(empty() && "reserving a non-empty ready_queue");
+        const cur_t capacity =
+            std::bit_ceil(std::max<cur_t>(min_capacity, min_ring_capacity));
+        ring = std::make_unique<std::coroutine_handle<>[]>(capacity);
+        mask = capacity - 1;
+        head = tail = 0;
+    }
+
+    [[nodiscard]]
+    cur_t capacity() const noexcept {
+        return mask + 1;
+    }
+
+    // Reaching this size of the ring is counted as a warning.
+    [[nodiscard]]
+    cur_t warning_level() const noexcept {
+        return capacity() / 4 * 3;
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept {
+        return head == tail;
+    }
+
+    [[nodiscard]]
+    size_t size() const noexcept {
+        return ring_size() + spill.size();
+    }
+
+    [[nodiscard]]
+    bool is_spilling() const noexcept {
+        return !spill.empty();
+    }
+
+    [[nodiscard]]
+    const stats &get_stats() const noexcept {
+        return counters;
+    }
+
+    /**
+     * @brief Push a coroutine, spilling once the ring is full.
+     * @note If the spill area cannot grow, std::bad_alloc escapes noexcept
+     * and std::terminate() is called. A ready coroutine cannot be dropped,
+     * and the completion path has no way to report it.
+     */
+    void push(std::coroutine_handle<> handle) noexcept {
+        assert(bool(handle) && "pushing an empty task");
+        assert(ring != nullptr && "pushing before reserve()");
+        // Keep the FIFO order: nothing jumps ahead of the spilled ones.
+        if (spill.empty() && ring_size() != capacity()) [[likely]] {
+            ring[tail++ & mask] = handle;
+            if (ring_size() == warning_level()) [[unlikely]] {
+                ++counters.warning_count;
+            }
+            return;
+        }
+        push_spill(handle);
+    }
+
+    /**
+     * @brief Pop the oldest coroutine. Guarantee to be non-null.
+     * @pre !empty()
+     */
+    [[nodiscard]]
+    std::coroutine_handle<> pop() noexcept {
+        assert(!empty());
+        const std::coroutine_handle<> handle = ring[head++ & mask];
+        if (empty() && !spill.empty()) [[unlikely]] {
+            drain_spill();
+        }
+        return handle;
+    }
+
+  private:
+    static constexpr cur_t min_ring_capacity = 4;
+
+    [[nodiscard]]
+    cur_t ring_size() const noexcept {
+        return tail - head;
+    }
+
+    // Terminates on std::bad_alloc, see push().
+    void push_spill(std::coroutine_handle<> handle) noexcept {
+        spill.push_back(handle);
+        ++counters.overflow_count;
+        if (spill.size() > counters.max_spill_size) {
+            counters.max_spill_size = spill.size();
+        }
+    }
+
+    void drain_spill() noexcept {
+        while (!spill.empty() && ring_size() != capacity()) {
+            ring[tail++ & mask] = spill.front();
+            spill.pop_front();
+        }
+    }
+
+  private:
+    std::unique_ptr<std::coroutine_handle<>[]> ring;
+    cur_t mask = 0;
+    cur_t head = 0;
+    cur_t tail = 0;
+    std::deque<std::coroutine_handle<>> spill;
+    stats counters;
+};
+
+} // namespace co_context::detail
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <co_context/config/net.hpp>
+#include <co_context/detail/task_info.hpp>
+#include <co_context/detail/thread_meta.hpp>
+#include <co_context/detail/user_data.hpp>
+#include <co_context/detail/worker_meta.hpp>
+
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <coroutine>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+namespace co_context::detail {
+
+/**
+ * @brief Decides whether a socket tries a non-blocking syscall before
+ * submitting a sqe, by the hit rate of its recent tries. Once the rate drops,
+ * the socket submits directly for a run of I/O, which doubles on each drop.
+ */
+class speculation {
+  public:
+    [[nodiscard]]
+    bool should_try() noexcept {
+        if (skips == 0) [[likely]] {
+            return true;
+        }
+        --skips;
+        return false;
+    }
+
+    void record(bool is_hit) noexcept {
+        hits += uint16_t(is_hit);
+        if (++tries < config::speculation_window) {
+            return;
+        }
+        if (hits * 4 < tries) {
+            skips = backoff;
+            backoff = uint16_t(std::min<uint32_t>(
+                uint32_t(backoff) * 2, config::speculation_max_backoff
+            ));
+        } else {
+            backoff = config::speculation_window;
+        }
+        tries = 0;
+        hits = 0;
+    }
+
+  private:
+    uint16_t tries = 0;
+    uint16_t hits = 0;
+    uint16_t skips = 0;
+    uint16_t backoff = config::speculation_window;
+};
+
+/**
+ * @brief Runs `Op` by a syscall in await_ready(), and submits it only if the
+ * syscall would block. Unlike lazy_awaiter, the sqe is taken on suspension,
+ * so it cannot be linked by `&&`.
+ */
+template<typename Op>
+class speculative_awaiter : private Op {
+  public:
+    template<typename... Args>
+    explicit speculative_awaiter(speculation &spec, Args &&...args) noexcept
+        : Op{std::forward<Args>(args)...}
+        , spec(spec) {}
+
+    [[nodiscard]]
+    bool await_ready() noexcept {
+        if (!Op::may_try() || !spec.should_try()) {
+            return false;
+        }
+        const int32_t res = Op::try_now();
+        const bool is_hit = res != -EAGAIN && res != -EINTR;
+        spec.record(is_hit);
+        auto &metrics = this_thread.worker->metrics;
+        metrics_counters::add(
+            is_hit ? metrics.speculative_hits : metrics.speculative_misses, 1
+        );
+        io_info.result = res;
+        return is_hit;
+    }
+
+    void await_suspend(std::coroutine_handle<> current) noexcept {
+        worker_meta *const worker = this_thread.worker;
+        liburingcxx::sq_entry *const sqe = worker->get_free_sqe();
+        Op::prepare(*sqe);
+        io_info.handle = current;
+        io_info.prio = worker->current_priority;
+#if CO_CONTEXT_USE_LATENCY_HISTOGRAM
+        io_info.opcode = sqe->get_opcode();
+        io_info.submit_ns = latency_clock_ns();
+#endif
+        sqe->set_data(
+            io_info.as_user_data() | uint64_t(user_data_type::task_info_ptr)
+        );
+        trace(trace_event::suspend_io, current, sqe->get_opcode());
+    }
+
+    /*NOLINT*/ int32_t await_resume() const noexcept { return io_info.result; }
+
+    speculative_awaiter(const speculative_awaiter &) = delete;
+    speculative_awaiter &operator=(const speculative_awaiter &) = delete;
+
+  private:
+    speculation &spec;
+    task_info io_info;
+};
+
+struct speculative_recv {
+    int sockfd;
+    std::span<char> buf;
+    int flags;
+
+    // MSG_WAITALL is kept by the ring across partial reads, not by a try.
+    [[nodiscard]]
+    bool may_try() const noexcept {
+        return (flags & MSG_WAITALL) == 0;
+    }
+
+    [[nodiscard]]
+    int32_t try_now() const noexcept {
+        const ssize_t res =
+            ::recv(sockfd, buf.data(), buf.size(), flags | MSG_DONTWAIT);
+        return res >= 0 ? int32_t(res) : -errno;
+    }
+
+    void prepare(liburingcxx::sq_entry &sqe) const noexcept {
+        sqe.prep_recv(sockfd, buf, flags);
+    }
+};
+
+struct speculative_send {
+    int sockfd;
+    std::span<const char> buf;
+    int flags;
+
+    [[nodiscard]]
+    bool may_try() const noexcept {
+        return (flags & MSG_WAITALL) == 0;
+    }
+
+    [[nodiscard]]
+    int32_t try_now() const noexcept {
+        const ssize_t res =
+            ::send(sockfd, buf.data(), buf.size(), flags | MSG_DONTWAIT);
+        return res >= 0 ? int32_t(res) : -errno;
+    }
+
+    void prepare(liburingcxx::sq_entry &sqe) const noexcept {
+        sqe.prep_send(sockfd, buf, flags);
+    }
+};
+
+// The listening socket must be non-blocking, which
+// acceptor::accept_speculative() makes it.
+struct speculative_accept {
+    int listen_fd;
+    int flags;
+
+    [[nodiscard]]
+    static constexpr bool may_try() noexcept {
+        return true;
+    }
+
+    [[nodiscard]]
+    int32_t try_now() const noexcept {
+        const int res = ::accept4(listen_fd, nullptr, nullptr, flags);
+        return res >= 0 ? res : -errno;
+    }
+
+    void prepare(liburingcxx::sq_entry &sqe) const noexcept {
+        sqe.prep_accept(listen_fd, nullptr, nullptr, flags);
+    }
+};
+
+} // namespace co_context::detail
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <co_context/config/io_context.hpp>
+#include <co_context/detail/spinlock.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace co_context::detail {
+
+/**
+ * @brief A FIFO of ready coroutines, which an io_context in work-stealing mode
+ * shares with its peers.
+ * @note Both the owner and the thieves only touch it in batches, so a
+ * spinlock is good enough.
+ */
+class steal_queue final {
+  public:
+    using cur_t = config::cur_t;
+
+    /**
+     * @brief A racy hint of the size, so that thieves can skip empty queues
+     * without locking.
+     */
+    [[nodiscard]]
+    cur_t size_hint() const noexcept {
+        return num.load(std::memory_order_relaxed);
+    }
+
+    template<typename Iter>
+    void push_bulk(Iter first, Iter last) {
+        std::lock_guard lg{mtx};
+        queue.insert(queue.end(), first, last);
+        num.store(cur_t(queue.size()), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Pop at most `max_num` coroutines from the front.
+     * @param f Invoked on each popped coroutine, while the lock is held.
+     * @return number of popped coroutines
+     */
+    template<typename F>
+    cur_t pop_bulk(cur_t max_num, F &&f) {
+        std::lock_guard lg{mtx};
+        const cur_t n = std::min<cur_t>(max_num, queue.size());
+        for (cur_t i = 0; i < n; ++i) {
+            f(queue.front());
+            queue.pop_front();
+        }
+        num.store(cur_t(queue.size()), std::memory_order_relaxed);
+        return n;
+    }
+
+    /**
+     * @brief Pop half (rounded up) of the coroutines, but no more than
+     * `max_num`.
+     */
+    template<typename F>
+    cur_t steal_half(cur_t max_num, F &&f) {
+        std::lock_guard lg{mtx};
+        const auto half = cur_t((queue.size() + 1) / 2);
+        const cur_t n = std::min<cur_t>(max_num, half);
+        for (cur_t i = 0; i < n; ++i) {
+            f(queue.front());
+            queue.pop_front();
+        }
+        num.store(cur_t(queue.size()), std::memory_order_relaxed);
+        return n;
+    }
+
+  private:
+    spinlock mtx;
+    std::atomic<cur_t> num{0};
+    std::deque<std::coroutine_handle<>> queue;
+};
+
+} // namespace co_context::detail
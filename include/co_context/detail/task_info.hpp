@@ -1,5 +1,7 @@
 #pragma once
+#include <co_context/config/config.hpp>
 #include <co_context/detail/compat.hpp>
+#include <co_context/detail/priority.hpp>
 #include <co_context/log/log.hpp>
 
 #include <coroutine>
@@ -13,6 +15,24 @@ struct [[nodiscard]] task_info {
 
     int32_t result;
 
+    // the lane to resume `handle`
+    priority prio;
+
+    // the low byte of the cqe flags, e.g. IORING_CQE_F_BUFFER
+    uint8_t cqe_flags;
+
+    // the provided buffer picked by the kernel, if IORING_CQE_F_BUFFER is set
+    uint16_t buf_id;
+
+#if CO_CONTEXT_USE_LATENCY_HISTOGRAM
+    // opcode of the sqe, or IORING_OP_LAST if not known yet
+    uint8_t opcode;
+
+    // when the lazy_io is constructed, and when its cqe is handled
+    uint64_t submit_ns;
+    uint64_t complete_ns;
+#endif
+
     [[nodiscard]]
     uint64_t as_user_data() const noexcept {
         return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(this));
@@ -23,6 +43,9 @@ inline constexpr uintptr_t raw_task_info_mask =
     ~uintptr_t(alignof(task_info) - 1);
 
 static_assert((~raw_task_info_mask) == 0x7);
+static_assert(
+    sizeof(task_info) == (CO_CONTEXT_USE_LATENCY_HISTOGRAM ? 40 : 16)
+);
 
 inline task_info *raw_task_info_ptr(uintptr_t info) noexcept {
     return CO_CONTEXT_ASSUME_ALIGNED(alignof(task_info))(
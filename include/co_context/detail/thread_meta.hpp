@@ -1,5 +1,6 @@
 #pragma once
 
+#include <co_context/config/config.hpp>
 #include <co_context/config/io_context.hpp>
 #include <co_context/detail/uring_type.hpp>
 
@@ -12,6 +13,7 @@ class io_context;
 namespace co_context::detail {
 
 struct worker_meta;
+class trace_buffer;
 
 struct alignas(config::cache_line_size) thread_meta {
     // The running io_context on this thread.
@@ -19,6 +21,11 @@ struct alignas(config::cache_line_size) thread_meta {
     worker_meta *worker = nullptr; // ctx + offset = worker
 
     config::ctx_id_t ctx_id = static_cast<config::ctx_id_t>(-1);
+
+#if CO_CONTEXT_USE_TRACE
+    // The trace buffer of the running io_context.
+    trace_buffer *tracer = nullptr;
+#endif
 };
 
 extern thread_local thread_meta this_thread; // NOLINT(*global-variables)
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <co_context/config/config.hpp>
+#include <co_context/config/io_context.hpp>
+#include <co_context/detail/spsc_cursor.hpp>
+#include <co_context/detail/thread_meta.hpp>
+#include <co_context/detail/thread_safety.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+
+namespace co_context::detail {
+
+enum class trace_event : uint8_t {
+    spawn,      // arg = ctx_id of the target
+    resume,     // the worker resumes the coroutine
+    yield,      // the coroutine returns to the worker
+    suspend_io, // arg = opcode
+    complete,   // arg = cqe->res
+    hop_out,    // arg = ctx_id of the target
+    hop_in,     // the coroutine arrives from another io_context
+};
+
+struct trace_record {
+    uint64_t ts_ns;
+    uint64_t coro;
+    uint32_t arg;
+    config::ctx_id_t ctx_id;
+    trace_event event;
+};
+
+static_assert(sizeof(trace_record) == 24);
+
+// if trace_start() has been called and trace_stop() has not
+inline std::atomic_bool is_tracing{false};
+
+/**
+ * @brief Records of an io_context, pushed by its host thread and drained by
+ * the flusher thread. Records are dropped while the buffer is full.
+ */
+class trace_buffer final {
+  public:
+    static constexpr uint32_t capacity = config::trace_buffer_capacity;
+
+    void push(trace_event event, const void *coro, uint32_t arg) noexcept {
+        if (!cur.is_available_load_head()) [[unlikely]] {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        records[cur.tail()] = {
+            .ts_ns = uint64_t(
+                std::chrono::steady_clock::now().time_since_epoch().count()
+            ),
+            .coro = uint64_t(reinterpret_cast<uintptr_t>(coro)),
+            .arg = arg,
+            .ctx_id = this_thread.ctx_id,
+            .event = event,
+        };
+        cur.push();
+    }
+
+    /**
+     * @brief Called by the flusher. f(const trace_record *, count) is called
+     * for each contiguous run of records.
+     */
+    template<typename F>
+    void drain(F &&f) {
+        const uint32_t tail = cur.load_raw_tail();
+        uint32_t head = cur.raw_head();
+        while (head != tail) {
+            const uint32_t begin = head & (capacity - 1);
+            const uint32_t run = std::min(tail - head, capacity - begin);
+            f(&records[begin], run);
+            head += run;
+            cur.pop(run);
+        }
+    }
+
+    [[nodiscard]]
+    uint64_t dropped_count() const noexcept {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    trace_buffer() : records(std::make_unique<trace_record[]>(capacity)) {}
+
+  private:
+    spsc_cursor<uint32_t, capacity, safe, false> cur;
+    std::atomic<uint64_t> dropped{0};
+    std::unique_ptr<trace_record[]> records;
+};
+
+// Join the flusher of trace_start(). Called by the host thread.
+void register_trace_buffer(trace_buffer &buffer);
+
+// Flush and leave the flusher. Called by the host thread.
+void unregister_trace_buffer(trace_buffer &buffer) noexcept;
+
+/**
+ * @brief Record an event of the coroutine on this thread, if tracing.
+ * Compiled away without the cmake option ENABLE_TRACE.
+ */
+inline void trace(
+    [[maybe_unused]] trace_event event,
+    [[maybe_unused]] std::coroutine_handle<> coro,
+    [[maybe_unused]] uint32_t arg = 0
+) noexcept {
+#if CO_CONTEXT_USE_TRACE
+    trace_buffer *const buffer = this_thread.tracer;
+    if (buffer != nullptr && is_tracing.load(std::memory_order_relaxed)) {
+        buffer->push(event, coro.address(), arg);
+    }
+#endif
+}
+
+} // namespace co_context::detail
@@ -7,23 +7,12 @@
 
 namespace co_context::detail {
 
+/**
+ * @note Only the flags fixed at compile time are given here. The others
+ * (e.g. COOP_TASKRUN, SINGLE_ISSUER, DEFER_TASKRUN) are chosen per io_context
+ * at runtime, see `io_context_options`.
+ */
 using uring = liburingcxx::uring<
-    config::io_uring_setup_flags
-    | config::uring_setup_flags
-#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
-    /**
-     * @note IORING_SETUP_COOP_TASKRUN is used because only one thread can
-     * access the ring
-     */
-    // PERF check IORING_SETUP_TASKRUN_FLAG
-    | config::io_uring_coop_taskrun_flag
-#endif
-#if LIBURINGCXX_IS_KERNEL_REACH(6, 0)
-    | IORING_SETUP_SINGLE_ISSUER
-#endif
-#if LIBURINGCXX_IS_KERNEL_REACH(6, 1)
-    | IORING_SETUP_DEFER_TASKRUN
-#endif
-    >;
+    config::io_uring_setup_flags | config::uring_setup_flags>;
 
 } // namespace co_context::detail
@@ -8,6 +8,9 @@ enum class reserved_user_data : uint64_t {
     co_spawn_event,
 #endif
     nop,
+    wakeup,
+    // The sender's cqe of a msg_ring, which arrives only if it fails.
+    msg_ring_failed,
     none
 };
 
@@ -16,6 +19,9 @@ enum class user_data_type : uint8_t {
     coroutine_handle,
     task_info_ptr__link_sqe,
     msg_ring,
+    msg_ring_batch,
+    multishot,
+    zero_copy,
     none
 };
 
@@ -1,17 +1,36 @@
 #pragma once
 
+#include <co_context/config/config.hpp>
 #include <co_context/config/io_context.hpp>
+#include <co_context/detail/frame_pool.hpp>
 #include <co_context/detail/io_context_meta.hpp>
-#include <co_context/detail/spsc_cursor.hpp>
+#include <co_context/detail/latency_histogram.hpp>
+#include <co_context/detail/mpsc_queue.hpp>
+#include <co_context/detail/msg_ring_channel.hpp>
+#include <co_context/detail/priority.hpp>
+#include <co_context/detail/ready_queue.hpp>
+#include <co_context/detail/steal_queue.hpp>
 #include <co_context/detail/thread_meta.hpp>
+#include <co_context/detail/trace_buffer.hpp>
 #include <co_context/detail/uring_type.hpp>
 #include <co_context/detail/user_data.hpp>
+#include <co_context/fixed_buffer.hpp>
+#include <co_context/io_context_metrics.hpp>
+#include <co_context/io_context_options.hpp>
 #include <co_context/log/log.hpp>
+#include <co_context/uring_features.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <coroutine>
 #include <cstdint>
-#if CO_CONTEXT_IS_USING_EVENTFD
+#include <memory>
 #include <mutex>
+#include <utility>
+#include <vector>
+#if CO_CONTEXT_IS_USING_EVENTFD
 #include <queue>
 #endif
 
@@ -57,50 +76,185 @@ struct worker_meta final {
 
     config::ctx_id_t ctx_id;
 
+    // tells apart the workers reusing the same ctx_id, see io_context_meta
+    uint64_t generation = 0;
+
+    // if this worker shares and steals ready coroutines with its peers
+    bool is_work_stealing = false;
+
     /**
      * ---------------------------------------------------
      * read-writable sharing data
      * ---------------------------------------------------
      */
 
+    using spawn_item = std::pair<std::coroutine_handle<>, priority>;
+
+    // if the worker has started and not stopped yet
+    std::atomic_bool is_running{false};
+
+    // Coroutines spawned by other threads before this worker starts.
+    std::mutex pending_mtx;
+    std::vector<spawn_item> pending_spawns;
+    // if the worker has stopped, guarded by pending_mtx
+    bool is_stopped = false;
+
 #if CO_CONTEXT_IS_USING_EVENTFD
+    // coroutines spawned by other threads
+    mpsc_queue<spawn_item, config::co_spawn_queue_capacity> co_spawn_queue;
+
+    // if the co_spawn_event_fd has been written since the last drain
+    alignas(cache_line_size) std::atomic_bool is_co_spawn_notified{false};
+
+    // Used only when co_spawn_queue is full.
     alignas(cache_line_size) std::mutex co_spawn_mtx;
-    // TODO replace this with spsc fixed-sized queue.
-    std::queue<std::coroutine_handle<>> co_spawn_queue;
+    std::atomic_bool has_co_spawn_overflow{false};
+    std::queue<spawn_item> co_spawn_overflow;
+#endif
+
+#if CO_CONTEXT_IS_USING_MSG_RING
+    // Channels from other io_contexts, indexed by their ctx_id.
+    alignas(cache_line_size) std::mutex inbox_mtx;
+    std::vector<std::unique_ptr<msg_ring_channel>> inbox;
+    // Channels replaced by larger ones, which may still be notified.
+    std::vector<std::unique_ptr<msg_ring_channel>> outgrown_inbox;
 #endif
 
+    // Ready coroutines shared with thieves, in work-stealing mode.
+    alignas(cache_line_size) steal_queue shared_ready;
+
+    // if this worker is (about to be) blocked, waiting for a wakeup
+    std::atomic_bool is_parked{false};
+
+    // counters written by the host thread, see io_context::metrics()
+    metrics_counters metrics;
+
     /**
      * ---------------------------------------------------
      * Thread-local read/write data
      * ---------------------------------------------------
      */
 
-    alignas(cache_line_size
-    ) std::array<std::coroutine_handle<>, config::swap_capacity> reap_swap;
-
     using cur_t = config::cur_t;
 
-    spsc_cursor<cur_t, config::swap_capacity, unsafe> reap_cur;
+    // coroutines ready to be resumed, per priority lane
+    alignas(cache_line_size) std::array<ready_queue, priority_num> reap_swap;
+
+    // weights left for each lane in this round, see config::priority_weights
+    std::array<uint32_t, priority_num> lane_credits = config::priority_weights;
+    static_assert(config::priority_weights.size() == priority_num);
+
+    // priority of the running coroutine
+    priority current_priority = priority::normal;
 
 #if CO_CONTEXT_IS_USING_EVENTFD
-    // TODO replace this with fixed-sized queue.
-    std::queue<std::coroutine_handle<>> co_spawn_local_queue;
+    std::queue<spawn_item> co_spawn_local_queue;
+#endif
+
+#if CO_CONTEXT_IS_USING_MSG_RING
+    struct outbox_entry {
+        msg_ring_channel *channel = nullptr;
+        // the generation of the receiver
+        uint64_t generation = 0;
+    };
+
+    // Channels to other io_contexts, indexed by their ctx_id.
+    std::vector<outbox_entry> outbox;
+
+    // channels pushed since the last flush_outbox()
+    std::vector<msg_ring_channel *> dirty_outbox;
 #endif
 
     // number of I/O tasks running inside io_uring
     int32_t requests_to_reap = 0;
 
+    // A cqe moved out of the cq ring, handled by the next poll_completion().
+    struct deferred_cqe {
+        uint64_t user_data;
+        int32_t res;
+        uint32_t flags;
+    };
+
+    // cqes moved out by submit_on_full_sq(), which must not handle them
+    std::vector<deferred_cqe> deferred_cqes;
+
+    // upper bound of busy-polling, 0 for never spinning
+    uint32_t max_spin_ns = 0;
+
+    // EWMA of the time from going idle to the next completion
+    uint32_t idle_gap_ns = 0;
+
+    // submit within a round once so many sqes are pending, -1U for never
+    uint32_t submit_batch_max = -1U;
+
+    // bound of the delay of an sqe within a round, 0 for unbounded
+    uint32_t submit_budget_ns = 0;
+
+    // EWMA of the time to resume a coroutine, learned under a budget
+    uint32_t resume_cost_ns = 0;
+
+    // coroutines to resume between submits within a round
+    uint32_t resumes_per_submit = -1U;
+
+    struct spin_stats {
+        // a completion arrived while spinning
+        uint64_t hit_count = 0;
+        // nothing arrived within the budget, then blocked
+        uint64_t miss_count = 0;
+    } spin_counters;
+
     // if there is at least one entry to submit to io_uring
     uint32_t requests_to_submit = 0;
 
+    // the frame pool of the host thread
+    frame_pool *frames = nullptr;
+
+    // buffers registered to the ring, see io_context::fixed_buffers()
+    fixed_buffer_pool fixed_buffers;
+
+    // slots of the file table registered to the ring, 0 if none
+    uint32_t fixed_file_num = 0;
+
+    // what the kernel supports, see io_context::features()
+    uring_features features;
+
+    // see io_context_options::send_zc_min_bytes
+    uint32_t send_zc_min_bytes = config::send_zc_min_bytes;
+
+#if CO_CONTEXT_USE_LATENCY_HISTOGRAM
+    // latency of lazy_io per opcode, see io_context::latency_stats()
+    latency_stats latency;
+#endif
+
+#if CO_CONTEXT_USE_TRACE
+    // lifecycle of coroutines on this worker, see trace_start()
+    trace_buffer tracer;
+#endif
+
     // if there is at least one task newly spawned or forwarded
     [[nodiscard]]
     bool has_task_ready() const noexcept {
-        return !reap_cur.is_empty();
+        return !(
+            reap_swap[0].empty() && reap_swap[1].empty() && reap_swap[2].empty()
+        );
     }
 
     liburingcxx::sq_entry *get_free_sqe() noexcept;
 
+    /**
+     * @brief Submit early to make room for an sqe, counted by sq_full_submits.
+     * If the kernel takes no sqe, e.g. while the cq overflows, the cqes are
+     * deferred to make room, then it retries.
+     */
+    liburingcxx::sq_entry *submit_on_full_sq() noexcept;
+
+    /**
+     * @brief Move the cqes out of the cq ring, so that the kernel may take
+     * sqes again while the cq overflows.
+     * @return the number of cqes moved.
+     */
+    uint32_t defer_cq_entries() noexcept;
+
     [[nodiscard]]
     bool is_ring_need_enter() const noexcept;
 
@@ -110,40 +264,231 @@ struct worker_meta final {
 
     void wait_uring() noexcept;
 
+    // wait_uring(), counting the time blocked.
+    void timed_wait_uring() noexcept;
+
     bool peek_uring() noexcept;
 
+    /**
+     * @brief Busy-poll the cq for a budget learned from the recent idle gaps,
+     * then block if nothing arrives.
+     */
+    void spin_or_wait_uring() noexcept;
+
+    // Spin only if a completion is likely to arrive within twice of the gap.
+    [[nodiscard]]
+    uint32_t spin_budget_ns() const noexcept {
+        const uint64_t budget = uint64_t(idle_gap_ns) * 2;
+        return budget <= max_spin_ns ? uint32_t(budget) : 0;
+    }
+
+    // Whether a round may submit before it ends.
+    [[nodiscard]]
+    bool is_submission_bounded() const noexcept {
+        return submit_batch_max != -1U || submit_budget_ns != 0;
+    }
+
+    void learn_resume_cost(uint64_t round_ns, uint32_t resumed) noexcept {
+        // EWMA with weight 1/8
+        const auto cost = int64_t(std::min<uint64_t>(
+            round_ns / std::max<uint32_t>(resumed, 1), UINT32_MAX
+        ));
+        resume_cost_ns =
+            uint32_t(int64_t(resume_cost_ns) + (cost - resume_cost_ns) / 8);
+        resumes_per_submit =
+            std::max<uint32_t>(submit_budget_ns / (resume_cost_ns + 1), 1);
+    }
+
+    void learn_idle_gap(uint64_t gap_ns) noexcept {
+        // EWMA with weight 1/8
+        const auto gap = int64_t(std::min<uint64_t>(gap_ns, UINT32_MAX));
+        idle_gap_ns = uint32_t(int64_t(idle_gap_ns) + (gap - idle_gap_ns) / 8);
+    }
+
     [[nodiscard]]
     cur_t number_to_schedule() const noexcept {
-        const auto &cur = this->reap_cur;
-        return cur.size();
+        return cur_t(
+            reap_swap[0].size() + reap_swap[1].size() + reap_swap[2].size()
+        );
     }
 
-    // Get a coroutine to run. Guarantee to be non-null.
+    [[nodiscard]]
+    ready_queue &lane(priority prio) noexcept {
+        return reap_swap[uint8_t(lane_of(prio))];
+    }
+
+    // A coroutine whose priority has the pin waits in its lane with the lowest
+    // address bit set, so that it is never shared.
+    [[nodiscard]]
+    static std::coroutine_handle<> as_pinned(std::coroutine_handle<> handle
+    ) noexcept {
+        return std::coroutine_handle<>::from_address(reinterpret_cast<void *>(
+            reinterpret_cast<uintptr_t>(handle.address()) | 1
+        ));
+    }
+
+    [[nodiscard]]
+    static bool is_pinned(std::coroutine_handle<> handle) noexcept {
+        return (reinterpret_cast<uintptr_t>(handle.address()) & 1) != 0;
+    }
+
+    [[nodiscard]]
+    static std::coroutine_handle<> unpinned(std::coroutine_handle<> handle
+    ) noexcept {
+        return std::coroutine_handle<>::from_address(reinterpret_cast<void *>(
+            reinterpret_cast<uintptr_t>(handle.address()) & ~uintptr_t(1)
+        ));
+    }
+
+    [[nodiscard]]
+    bool has_spilling_lane() const noexcept {
+        return reap_swap[0].is_spilling() || reap_swap[1].is_spilling()
+               || reap_swap[2].is_spilling();
+    }
+
+    /**
+     * @brief Get a coroutine to run by weighted round-robin among the lanes.
+     * Guarantee to be non-null. `current_priority` is set to its lane, and its
+     * pin if any.
+     */
     [[nodiscard]]
     std::coroutine_handle<> schedule() noexcept;
 
-    void init(unsigned io_uring_entries);
+    void init(unsigned io_uring_entries, const io_context_options &options);
 
     void deinit() noexcept;
 
+    /**
+     * @brief Accept the coroutines spawned by other threads, starting with the
+     * pending ones. Called by the host thread once the ring is ready.
+     */
+    void start_running() noexcept;
+
+    /**
+     * @brief Spawns from other threads are destroyed from now on, since this
+     * worker will never resume them.
+     */
+    void stop_running() noexcept;
+
+    /**
+     * @brief Destroy the coroutines spawned by other threads that arrived
+     * before stop_running() but were not resumed. Called after it.
+     */
+    void discard_late_spawns() noexcept;
+
+    /**
+     * @brief Keep the coroutine until this worker runs, or destroy it if this
+     * worker has stopped.
+     * @return false if this worker is running already.
+     */
+    [[nodiscard]]
+    bool
+    try_spawn_pending(std::coroutine_handle<> handle, priority prio) noexcept;
+
+    /**
+     * @brief Setup the ring, dropping the flags rejected by the kernel.
+     */
+    void init_ring(unsigned io_uring_entries, const io_context_options &options);
+
     void co_spawn_unsafe(std::coroutine_handle<> handle) noexcept;
 
+    void
+    co_spawn_unsafe(std::coroutine_handle<> handle, priority prio) noexcept;
+
 #if CO_CONTEXT_IS_USING_MSG_RING
-    void co_spawn_safe_msg_ring(std::coroutine_handle<> handle) const noexcept;
+    void co_spawn_safe_msg_ring(std::coroutine_handle<> handle, priority prio)
+        const noexcept;
+
+    /**
+     * @brief Push to the outbox of this thread, which is sent to this worker
+     * by flush_outbox(). Grow the channel if full, and fall back to
+     * co_spawn_safe_msg_ring() once it is at its largest.
+     */
+    void co_spawn_batched_msg_ring(
+        std::coroutine_handle<> handle, priority prio
+    ) noexcept;
+
+    /**
+     * @brief Notify each io_context having new coroutines in the outbox,
+     * by a single msg_ring per io_context.
+     */
+    void flush_outbox() noexcept {
+        if (!dirty_outbox.empty()) {
+            notify_outbox();
+        }
+    }
+
+    void notify_outbox() noexcept;
+
+    // The channel from this worker to `target`.
+    [[nodiscard]]
+    msg_ring_channel &channel_to(worker_meta &target) {
+        if (target.ctx_id < outbox.size()) [[likely]] {
+            const outbox_entry &entry = outbox[target.ctx_id];
+            if (entry.channel != nullptr
+                && entry.generation == target.generation) [[likely]] {
+                return *entry.channel;
+            }
+        }
+        return new_channel_to(target);
+    }
+
+    /**
+     * @brief Look up the channel to `target`, replacing the one to a stopped
+     * worker with the same ctx_id.
+     */
+    msg_ring_channel &new_channel_to(worker_meta &target);
+
+    // Replace the full channel to `target` by one four times as large.
+    msg_ring_channel &grow_channel_to(worker_meta &target);
+
+    /**
+     * @brief The channel from `sender` to this worker, created on demand. If
+     * `min_capacity` is larger than the current one, it is replaced.
+     */
+    msg_ring_channel &inbox_from(
+        const worker_meta &sender,
+        cur_t min_capacity = config::msg_ring_batch_initial_capacity
+    );
 #else
-    void co_spawn_safe_eventfd(std::coroutine_handle<> handle) noexcept;
+    void
+    co_spawn_safe_eventfd(std::coroutine_handle<> handle, priority prio) noexcept;
+
+    /**
+     * @brief Write the co_spawn_event_fd, unless it has been written and not
+     * drained yet.
+     */
+    void notify_co_spawn() noexcept {
+        if (!is_co_spawn_notified.exchange(true, std::memory_order_acq_rel)) {
+            ::eventfd_write(co_spawn_event_fd, 1);
+        }
+    }
 #endif
 
+    // Spawn with the priority of the running coroutine on this thread.
     void co_spawn_auto(std::coroutine_handle<> handle) noexcept;
 
+    void co_spawn_auto(std::coroutine_handle<> handle, priority prio) noexcept;
+
     void work_once();
 
-    void check_submission_threshold() noexcept;
+    // Resume `num` coroutines, submitting as the policy of the options says.
+    void work_bounded(uint32_t num);
+
+    // Submit the sqes of the round so far.
+    void submit_in_round() noexcept;
+
+    // Count a submission, and sample the counters of the kernel.
+    void record_submission(int submitted) noexcept;
+
+    // Count a blocking wait for completions, which began at `start`.
+    void record_wait(std::chrono::steady_clock::time_point start) noexcept;
 
     /**
      * @brief poll the submission swap zone
+     * @param may_wait false if the worker must not block, e.g. it is leaving
      */
-    void poll_submission() noexcept;
+    void poll_submission(bool may_wait = true) noexcept;
 
     /**
      * @brief poll the uring completion queue
@@ -153,16 +498,73 @@ struct worker_meta final {
     uint32_t poll_completion() noexcept;
 
     /**
-     * @brief forward a coroutine to the reap_swap.
-     * @warning The reap_swap will not be checked for full.
+     * @brief forward a coroutine to the reap_swap, in the lane of the running
+     * coroutine, keeping its pin.
+     * @note The reap_swap spills into a growable area once it is full.
+     */
+    void forward_task(std::coroutine_handle<> handle) noexcept {
+        forward_task(handle, current_priority);
+    }
+
+    void forward_task(std::coroutine_handle<> handle, priority prio) noexcept;
+
+    /**
+     * @brief forward a coroutine spawned by another io_context, which must be
+     * resumed by this worker from now on. In work-stealing mode, it is pinned.
+     */
+    void
+    forward_pinned_task(std::coroutine_handle<> handle, priority prio) noexcept;
+
+    /**
+     * @brief Join the work-stealing peers. Called after init().
+     */
+    void register_steal_peer() noexcept;
+
+    void unregister_steal_peer() noexcept;
+
+    /**
+     * @brief Share the surplus of the normal lane with the peers, and take
+     * back the unclaimed ones. Called before each round of do_worker_part()
+     * in work-stealing mode.
+     */
+    void rebalance();
+
+    /**
+     * @brief Try to steal ready coroutines from the peers (or from itself).
+     * @return if any coroutine is forwarded to the reap_swap
+     */
+    bool try_steal() noexcept;
+
+    /**
+     * @brief Mark this worker as parked, then check the peers for the last
+     * time.
+     * @return true if it is ok to block; false if some coroutines are stolen.
      */
-    void forward_task(std::coroutine_handle<> handle) noexcept;
+    bool park() noexcept;
+
+    void unpark() noexcept {
+        is_parked.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Wake up a parked peer to steal the shared coroutines.
+     */
+    void wake_up_a_thief() noexcept;
+
+    /**
+     * @brief Interrupt the blocking wait of this worker. Called by other
+     * threads.
+     */
+    void wake_up() noexcept;
 
     /**
      * @brief handle an non-null cq_entry from the cq of io_uring
      */
     void handle_cq_entry(const liburingcxx::cq_entry *) noexcept;
 
+    // handle a cqe already moved out of the cq ring
+    void handle_cq_entry(const deferred_cqe &cqe) noexcept;
+
     void handle_reserved_user_data(uint64_t user_data) noexcept;
 
 #if CO_CONTEXT_IS_USING_EVENTFD
@@ -176,32 +578,54 @@ struct worker_meta final {
 
   private:
     [[nodiscard]]
-    bool check_init(unsigned expect_sqring_size) const noexcept;
+    bool check_init(
+        unsigned expect_sqring_size, const io_context_options &options
+    ) const noexcept;
+
+    // Fill `features` from the ring and the probe of the kernel.
+    void probe_features() noexcept;
+
+    // Whether the kernel supports the paths compiled in unconditionally.
+    // Only recv_stream, accept_stream and send_zc fall back at runtime;
+    // msg_ring over eventfd and cqe skipping are chosen at build time, so
+    // a kernel older than the build one is refused here.
+    [[nodiscard]]
+    bool check_features() const noexcept;
 };
 
 inline void worker_meta::co_spawn_unsafe(std::coroutine_handle<> handle
 ) noexcept {
     log::v("worker[%u] co_spawn_unsafe coro(%lx)\n", ctx_id, handle.address());
-    forward_task(handle);
+    forward_task(handle, lane_of(current_priority));
+}
+
+inline void worker_meta::co_spawn_unsafe(
+    std::coroutine_handle<> handle, priority prio
+) noexcept {
+    log::v("worker[%u] co_spawn_unsafe coro(%lx)\n", ctx_id, handle.address());
+    forward_task(handle, prio);
 }
 
 #if CO_CONTEXT_IS_USING_EVENTFD
-inline void worker_meta::co_spawn_safe_eventfd(std::coroutine_handle<> handle
+inline void worker_meta::co_spawn_safe_eventfd(
+    std::coroutine_handle<> handle, priority prio
 ) noexcept {
     log::v(
         "coro(%lx) is pushing to worker[%u] by co_spawn_safe_eventfd() \n",
         handle.address(), ctx_id
     );
-    {
+    if (!co_spawn_queue.try_push({handle, prio})) [[unlikely]] {
         std::lock_guard lg{co_spawn_mtx};
-        co_spawn_queue.push(handle);
+        co_spawn_overflow.emplace(handle, prio);
+        has_co_spawn_overflow.store(true, std::memory_order_relaxed);
     }
-    ::eventfd_write(co_spawn_event_fd, 1);
+    notify_co_spawn();
 }
 #endif
 
 #if CO_CONTEXT_IS_USING_MSG_RING
-inline void worker_meta::co_spawn_safe_msg_ring(std::coroutine_handle<> handle
+inline void worker_meta::co_spawn_safe_msg_ring(
+    std::coroutine_handle<> handle, priority prio
 ) const noexcept {
     worker_meta &from = *this_thread.worker;
     log::v(
@@ -212,38 +636,88 @@ inline void worker_meta::co_spawn_safe_msg_ring(std::coroutine_handle<> handle
     auto *const sqe = from.get_free_sqe();
     auto user_data = reinterpret_cast<uint64_t>(handle.address())
                      | uint8_t(user_data_type::msg_ring);
-    sqe->prep_msg_ring(ring_fd, 0, user_data, 0);
-    sqe->set_data(uint64_t(reserved_user_data::nop));
+    // The priority is carried by cqe->res of the target ring.
+    sqe->prep_msg_ring(ring_fd, uint32_t(prio), user_data, 0);
+    sqe->set_data(uint64_t(reserved_user_data::msg_ring_failed));
 #if LIBURINGCXX_IS_KERNEL_REACH(5, 17)
     sqe->set_cqe_skip();
     --from.requests_to_reap;
 #endif
 }
+
+inline void worker_meta::co_spawn_batched_msg_ring(
+    std::coroutine_handle<> handle, priority prio
+) noexcept {
+    worker_meta &from = *this_thread.worker;
+    msg_ring_channel *channel = &from.channel_to(*this);
+    if (!channel->try_push(handle, prio)) [[unlikely]] {
+        if (channel->capacity() == config::msg_ring_batch_capacity) {
+            this->co_spawn_safe_msg_ring(handle, prio);
+            return;
+        }
+        channel = &from.grow_channel_to(*this);
+        [[maybe_unused]] const bool ok = channel->try_push(handle, prio);
+        assert(ok && "a grown channel must have room");
+    }
+    if (!channel->is_dirty) {
+        channel->is_dirty = true;
+        from.dirty_outbox.push_back(channel);
+    }
+}
 #endif
 
 inline void worker_meta::co_spawn_auto(std::coroutine_handle<> handle
 ) noexcept {
-    // MT-unsafe in some scenes (for meta.ready_count == 0)
-    // before calling io_context::start(), this_thread.ctx is nullptr.
-    if (detail::this_thread.worker == this
-        || io_context_meta.ready_count == 0) {
-        this->co_spawn_unsafe(handle);
-    } else {
+    const worker_meta *const from = detail::this_thread.worker;
+    this->co_spawn_auto(
+        handle,
+        from != nullptr ? lane_of(from->current_priority) : priority::normal
+    );
+}
+
+inline void worker_meta::co_spawn_auto(
+    std::coroutine_handle<> handle, priority prio
+) noexcept {
+    if (detail::this_thread.worker == this) {
+        this->co_spawn_unsafe(handle, prio);
+        return;
+    }
+    trace(trace_event::hop_out, handle, ctx_id);
+    // Before this worker starts, its ring is not ready to be notified. A move
+    // from another io_context stays pinned while pending.
+    const priority pending_prio =
+        detail::this_thread.worker != nullptr ? with_pin(prio) : prio;
+    if (!is_running.load(std::memory_order_acquire)
+        && try_spawn_pending(handle, pending_prio)) [[unlikely]] {
+        return;
+    }
 #if CO_CONTEXT_IS_USING_MSG_RING
-        this->co_spawn_safe_msg_ring(handle);
+    this->co_spawn_batched_msg_ring(handle, prio);
 #else
-        this->co_spawn_safe_eventfd(handle);
+    this->co_spawn_safe_eventfd(handle, prio);
 #endif
-    }
 }
 
 inline uint32_t worker_meta::poll_completion() noexcept {
     using cq_entry = liburingcxx::cq_entry;
 
-    uint32_t num = ring.for_each_cqe([this](const cq_entry *cqe) noexcept {
+    uint32_t num = 0;
+    if (!deferred_cqes.empty()) [[unlikely]] {
+        // Handled in order, before the newer cqes of the ring.
+        std::vector<deferred_cqe> cqes = std::move(deferred_cqes);
+        deferred_cqes.clear();
+        for (const deferred_cqe &cqe : cqes) {
+            this->handle_cq_entry(cqe);
+        }
+        num = uint32_t(cqes.size());
+    }
+
+    num += ring.for_each_cqe([this](const cq_entry *cqe) noexcept {
         this->handle_cq_entry(cqe);
     });
 
+    metrics_counters::add(metrics.cqe_reaped, num);
+    metrics_counters::add(metrics.completion_polls, 1);
     return num;
 }
 
@@ -257,6 +731,9 @@ inline void worker_meta::wait_uring() noexcept {
 }
 
 inline bool worker_meta::peek_uring() noexcept {
+    if (!deferred_cqes.empty()) [[unlikely]] {
+        return true;
+    }
     [[maybe_unused]] const liburingcxx::cq_entry *cqe;
     ring.peek_cq_entry(cqe);
     return cqe != nullptr;
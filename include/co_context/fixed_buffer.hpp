@@ -0,0 +1,183 @@
+#pragma once
+
+#include <co_context/detail/thread_meta.hpp>
+#include <co_context/detail/uring_type.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace co_context {
+
+class fixed_buffer_pool;
+
+/**
+ * @brief A lease of a buffer registered to the ring of an io_context. It
+ * goes back to the pool on destruction.
+ * @note Must be used and destructed on the thread of the io_context owning
+ * the pool, since `index()` is only meaningful to that ring. See
+ * io_context::set_work_stealing().
+ */
+class [[nodiscard]] fixed_buffer final {
+  public:
+    fixed_buffer() noexcept = default;
+
+    fixed_buffer(fixed_buffer &&other) noexcept
+        : pool(std::exchange(other.pool, nullptr))
+        , buf(std::exchange(other.buf, {}))
+        , buf_index(other.buf_index) {}
+
+    fixed_buffer &operator=(fixed_buffer &&other) noexcept {
+        if (this != &other) {
+            release();
+            pool = std::exchange(other.pool, nullptr);
+            buf = std::exchange(other.buf, {});
+            buf_index = other.buf_index;
+        }
+        return *this;
+    }
+
+    fixed_buffer(const fixed_buffer &) = delete;
+    fixed_buffer &operator=(const fixed_buffer &) = delete;
+
+    ~fixed_buffer() noexcept { release(); }
+
+    // false if the pool is exhausted or not enabled.
+    explicit operator bool() const noexcept { return pool != nullptr; }
+
+    [[nodiscard]]
+    char *data() const noexcept {
+        return buf.data();
+    }
+
+    [[nodiscard]]
+    size_t size() const noexcept {
+        return buf.size();
+    }
+
+    [[nodiscard]]
+    std::span<char> span() const noexcept {
+        return buf;
+    }
+
+    // The buf_index of read_fixed/write_fixed/send_zc_fixed.
+    [[nodiscard]]
+    uint16_t index() const noexcept {
+        return buf_index;
+    }
+
+    // Return the buffer to the pool early.
+    void release() noexcept;
+
+  private:
+    friend class fixed_buffer_pool;
+
+    fixed_buffer(
+        fixed_buffer_pool *pool, std::span<char> buf, uint16_t buf_index
+    ) noexcept
+        : pool(pool)
+        , buf(buf)
+        , buf_index(buf_index) {}
+
+    fixed_buffer_pool *pool = nullptr;
+    std::span<char> buf;
+    uint16_t buf_index = 0;
+};
+
+/**
+ * @brief Equal-sized buffers carved from one arena, which is registered to
+ * the ring of an io_context, so that the kernel pins its pages once instead
+ * of per I/O. Enabled by `io_context_options::fixed_buffer_num`.
+ * @note Not thread-safe. Owned and used by the thread of the io_context.
+ */
+class fixed_buffer_pool final {
+  public:
+    fixed_buffer_pool() noexcept = default;
+
+    ~fixed_buffer_pool() noexcept;
+
+    fixed_buffer_pool(const fixed_buffer_pool &) = delete;
+    fixed_buffer_pool &operator=(const fixed_buffer_pool &) = delete;
+
+    /**
+     * @brief Map the arena and register it to `ring`. On failure, a warning
+     * is logged and the pool stays empty.
+     * @param use_huge_pages Back the arena by 2 MiB huge pages, falling back
+     * to normal pages if none is reserved.
+     */
+    void init(
+        detail::uring &ring,
+        uint32_t buffer_num,
+        uint32_t buffer_size,
+        bool use_huge_pages
+    ) noexcept;
+
+    /**
+     * @brief Lend a free buffer.
+     * @return an empty lease if all buffers are lent.
+     */
+    [[nodiscard]]
+    fixed_buffer try_acquire() noexcept {
+        assert(is_on_owner() && "a fixed_buffer out of its io_context");
+        if (free_indexes.empty()) [[unlikely]] {
+            return {};
+        }
+        const uint16_t index = free_indexes.back();
+        free_indexes.pop_back();
+        return {this, {arena + size_t(index) * buffer_size, buffer_size}, index};
+    }
+
+    // number of buffers not lent
+    [[nodiscard]]
+    size_t available() const noexcept {
+        return free_indexes.size();
+    }
+
+    // number of registered buffers
+    [[nodiscard]]
+    uint32_t capacity() const noexcept {
+        return buffer_num;
+    }
+
+    [[nodiscard]]
+    uint32_t buffer_bytes() const noexcept {
+        return buffer_size;
+    }
+
+  private:
+    friend class fixed_buffer;
+
+    void give_back(uint16_t index) noexcept {
+        assert(is_on_owner() && "a fixed_buffer out of its io_context");
+        assert(free_indexes.size() < buffer_num);
+        free_indexes.push_back(index);
+    }
+
+    // false on a thief of a work-stealing io_context, see set_work_stealing().
+    [[nodiscard]]
+    bool is_on_owner() const noexcept {
+        return owner == detail::this_thread.worker;
+    }
+
+    // The worker whose ring registers the arena.
+    detail::worker_meta *owner = nullptr;
+    char *arena = nullptr;
+    size_t arena_size = 0;
+    uint32_t buffer_num = 0;
+    uint32_t buffer_size = 0;
+    // LIFO, so that the hottest buffer is lent first.
+    std::vector<uint16_t> free_indexes;
+};
+
+inline void fixed_buffer::release() noexcept {
+    if (pool != nullptr) {
+        pool->give_back(buf_index);
+        pool = nullptr;
+        buf = {};
+    }
+}
+
+} // namespace co_context
@@ -21,14 +21,18 @@
 #include <co_context/config/io_context.hpp>
 #include <co_context/detail/attributes.hpp>
 #include <co_context/detail/io_context_meta.hpp>
+#include <co_context/detail/priority.hpp>
 #include <co_context/detail/task_info.hpp>
 #include <co_context/detail/thread_meta.hpp>
 #include <co_context/detail/thread_safety.hpp>
 #include <co_context/detail/uring_type.hpp>
 #include <co_context/detail/worker_meta.hpp>
+#include <co_context/io_context_metrics.hpp>
+#include <co_context/io_context_options.hpp>
 #include <co_context/task.hpp>
 #include <uring/uring.hpp>
 
+#include <sched.h>
 #include <sys/types.h>
 #include <thread>
 
@@ -69,6 +73,13 @@ class [[nodiscard]] io_context final {
     // should io_context stop
     bool will_stop = false;
 
+    // if the host thread should be pinned to `cpu_affinity`
+    bool has_cpu_affinity = false;
+
+    cpu_set_t cpu_affinity;
+
+    io_context_options options;
+
     /**
      * ---------------------------------------------------
      * read-only sharing data (No data)
@@ -80,11 +91,16 @@ class [[nodiscard]] io_context final {
 
     void deinit() noexcept;
 
+    // Must be called by the host thread.
+    void apply_cpu_affinity() noexcept;
+
     // run on the current thread.
     void run();
 
     friend void co_spawn(task<void> &&entrance) noexcept;
 
+    friend void co_spawn(task<void> &&entrance, priority prio) noexcept;
+
     friend void co_spawn_unsafe(task<void> &&entrance) noexcept;
 
     void do_submission_part() noexcept;
@@ -97,14 +113,18 @@ class [[nodiscard]] io_context final {
     void do_worker_part();
 
   public:
-    explicit io_context() noexcept {
-        auto &meta = detail::io_context_meta;
-        std::lock_guard lg{meta.mtx};
-        this->id = meta.create_count++;
-        log::d(
-            "&meta.create_count = %lx  value = %u\n", &meta.create_count,
-            meta.create_count
-        );
+    explicit io_context() noexcept : io_context(io_context_options{}) {}
+
+    explicit io_context(const io_context_options &options) noexcept
+        : options(options) {
+        using config::minor_lane_capacity_divisor;
+        const uint32_t minor_capacity =
+            options.swap_capacity / minor_lane_capacity_divisor;
+        worker.lane(priority::high).reserve(minor_capacity);
+        worker.lane(priority::normal).reserve(options.swap_capacity);
+        worker.lane(priority::low).reserve(minor_capacity);
+        this->id = detail::io_context_meta.acquire_id();
+        log::d("io_context[%u] is constructed\n", this->id);
     }
 
     void co_spawn(task<void> &&entrance) noexcept;
@@ -112,8 +132,60 @@ class [[nodiscard]] io_context final {
     template<safety is_thread_safe>
     void co_spawn(task<void> &&entrance) noexcept;
 
+    /**
+     * @brief co_spawn into the given priority lane. By default, a coroutine
+     * inherits the priority of the coroutine that spawns it.
+     */
+    void co_spawn(task<void> &&entrance, priority prio) noexcept;
+
     void can_stop() noexcept { will_stop = true; }
 
+    /**
+     * @brief Let this io_context share its ready coroutines with, and steal
+     * ready coroutines from, the other io_contexts in work-stealing mode.
+     * @pre Must be called before start().
+     * @note A coroutine moved by `co_spawn()` or `resume_on()` from another
+     * io_context is always resumed here, i.e. it is never stolen, until it
+     * moves again. The coroutines it spawns or wakes up are not pinned.
+     * @warning A stolen coroutine runs on the ring of the thief. What is bound
+     * to the ring of this io_context, i.e. a recv_stream, an accept_stream,
+     * a fixed_buffer, a buffer_group and its provided_buffer, or a
+     * direct_socket, must not be used or destructed there, which is asserted.
+     * `co_await lazy::resume_on(this_io_context())` pins the coroutine here
+     * before it creates or uses them.
+     */
+    void set_work_stealing(bool enable) noexcept {
+        worker.is_work_stealing = enable;
+    }
+
+    /**
+     * @brief Pin the host thread to the given CPUs.
+     * @pre Must be called before start().
+     */
+    void set_cpu_affinity(const cpu_set_t &cpus) noexcept {
+        cpu_affinity = cpus;
+        has_cpu_affinity = true;
+    }
+
+    /**
+     * @brief Pin the host thread to the given CPU.
+     * @pre Must be called before start(), with 0 <= cpu < CPU_SETSIZE, or the
+     * process terminates.
+     */
+    void set_cpu_affinity(int cpu) noexcept {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) [[unlikely]] {
+            log::e(
+                "io_context[%u]: cpu %d is out of [0, %d)\n", id, cpu,
+                CPU_SETSIZE
+            );
+            std::terminate();
+        }
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        set_cpu_affinity(cpus);
+    }
+
     // start a standalone thread to run.
     void start();
 
@@ -125,7 +197,98 @@ class [[nodiscard]] io_context final {
 
     inline uring &ring() noexcept { return worker.ring; }
 
-    ~io_context() noexcept = default;
+    /**
+     * @brief Counters of the ready queue, telling how often the fixed-size
+     * ring overflows.
+     * @note Not thread-safe. Read it on the thread of this io_context, or
+     * after join().
+     */
+    [[nodiscard]]
+    const detail::ready_queue::stats &
+    ready_queue_stats(priority prio = priority::normal) const noexcept {
+        return worker.reap_swap[uint8_t(detail::lane_of(prio))].get_stats();
+    }
+
+    /**
+     * @brief Counters of busy-polling before blocking, see
+     * `io_context_options::max_spin_ns`.
+     * @note Not thread-safe, like ready_queue_stats().
+     */
+    [[nodiscard]]
+    const worker_meta::spin_stats &spin_stats() const noexcept {
+        return worker.spin_counters;
+    }
+
+    /**
+     * @brief A snapshot of the counters of this io_context, e.g. to tune
+     * batching or to spot a saturated core.
+     * @note Thread-safe. Each counter is read atomically, but the snapshot as
+     * a whole is not.
+     */
+    [[nodiscard]]
+    io_context_metrics metrics() const noexcept {
+        return worker.metrics.snapshot();
+    }
+
+    /**
+     * @brief Counters of the coroutine frame pool of the host thread, see
+     * `config::is_using_frame_pool`.
+     * @note Not thread-safe, like ready_queue_stats(). Empty before start().
+     */
+    [[nodiscard]]
+    detail::frame_pool::stats frame_pool_stats() const noexcept {
+        return worker.frames != nullptr ? worker.frames->get_stats()
+                                        : detail::frame_pool::stats{};
+    }
+
+    /**
+     * @brief The pool of buffers registered to the ring, whose leases are
+     * accepted by read_fixed(), write_fixed(), socket::recv() and
+     * socket::send(). Empty unless `io_context_options::fixed_buffer_num` is
+     * set.
+     * @note Not thread-safe. Use it on the thread of this io_context, after
+     * start().
+     */
+    [[nodiscard]]
+    fixed_buffer_pool &fixed_buffers() noexcept {
+        return worker.fixed_buffers;
+    }
+
+    /**
+     * @brief Slots of the file table for direct descriptors, 0 unless
+     * `io_context_options::fixed_file_num` is set and the kernel accepts it.
+     */
+    [[nodiscard]]
+    uint32_t fixed_files() const noexcept {
+        return worker.fixed_file_num;
+    }
+
+    /**
+     * @brief What the kernel supports, probed when the io_context is
+     * initialized. Optional paths, e.g. multishot accept, fall back by it.
+     * @note msg_ring and cqe skipping are chosen at build time, so the
+     * io_context refuses a kernel older than the one it is built for.
+     */
+    [[nodiscard]]
+    const uring_features &features() const noexcept {
+        return worker.features;
+    }
+
+#if CO_CONTEXT_USE_LATENCY_HISTOGRAM
+    /**
+     * @brief Latency histograms of lazy_io per opcode, from construction to
+     * completion, and from completion to resumption. Enabled by the cmake
+     * option ENABLE_LATENCY_HISTOGRAM.
+     * @note Not thread-safe, like ready_queue_stats().
+     */
+    [[nodiscard]]
+    const detail::latency_stats &latency_stats() const noexcept {
+        return worker.latency;
+    }
+#endif
+
+    // The id may be reused by an io_context constructed later.
+    ~io_context() noexcept { detail::io_context_meta.release_id(this->id); }
 
     /**
      * ban all copying or moving
@@ -151,6 +314,7 @@ template<safety is_thread_safe>
 inline void io_context::co_spawn(task<void> &&entrance) noexcept {
     auto handle = entrance.get_handle();
     entrance.detach();
+    detail::trace(detail::trace_event::spawn, handle, id);
     if constexpr (is_thread_safe) {
         worker.co_spawn_auto(handle);
     } else {
@@ -158,6 +322,14 @@ inline void io_context::co_spawn(task<void> &&entrance) noexcept {
     }
 }
 
+inline void
+io_context::co_spawn(task<void> &&entrance, priority prio) noexcept {
+    auto handle = entrance.get_handle();
+    entrance.detach();
+    detail::trace(detail::trace_event::spawn, handle, id);
+    worker.co_spawn_auto(handle, prio);
+}
+
 inline void co_spawn(task<void> &&entrance) noexcept {
     assert(
         detail::this_thread.ctx != nullptr
@@ -166,9 +338,26 @@ inline void co_spawn(task<void> &&entrance) noexcept {
     );
     auto handle = entrance.get_handle();
     entrance.detach();
+    detail::trace(
+        detail::trace_event::spawn, handle, detail::this_thread.ctx_id
+    );
     detail::this_thread.worker->co_spawn_unsafe(handle);
 }
 
+inline void co_spawn(task<void> &&entrance, priority prio) noexcept {
+    assert(
+        detail::this_thread.ctx != nullptr
+        && "Can not co_spawn() on the thread "
+           "without a running io_context!"
+    );
+    auto handle = entrance.get_handle();
+    entrance.detach();
+    detail::trace(
+        detail::trace_event::spawn, handle, detail::this_thread.ctx_id
+    );
+    detail::this_thread.worker->co_spawn_unsafe(handle, prio);
+}
+
 namespace detail {
     inline void co_spawn_handle(std::coroutine_handle<> handle) noexcept {
         assert(
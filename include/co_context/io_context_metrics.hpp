@@ -0,0 +1,130 @@
+#pragma once
+
+#include <co_context/config/io_context.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+namespace co_context {
+
+/**
+ * @brief A snapshot of the counters of an io_context, see
+ * `io_context::metrics()`. All counters accumulate since the io_context starts.
+ */
+struct io_context_metrics {
+    // sqes accepted by the kernel
+    uint64_t sqe_submitted = 0;
+    // io_uring_enter calls made to submit sqes
+    uint64_t submit_syscalls = 0;
+    // submits made early, within a round, since the sq ring is full
+    uint64_t sq_full_submits = 0;
+    // submits made within a round by submit_batch_max or submit_budget_ns
+    uint64_t round_submits = 0;
+
+    // cqes handled by the worker
+    uint64_t cqe_reaped = 0;
+    // polls of the cq, with or without any cqe
+    uint64_t completion_polls = 0;
+
+    // coroutines resumed by the worker
+    uint64_t coroutines_resumed = 0;
+    // rounds of resuming the ready coroutines
+    uint64_t worker_rounds = 0;
+
+    // times of blocking for a completion, and the time spent on it
+    uint64_t wait_count = 0;
+    uint64_t wait_ns = 0;
+
+    // peak number of ready coroutines at the beginning of a round
+    uint64_t ready_high_water = 0;
+
+    // speculative syscalls that completed, and that fell back to a sqe
+    uint64_t speculative_hits = 0;
+    uint64_t speculative_misses = 0;
+
+    // sqes dropped by the kernel for being invalid
+    uint64_t sq_dropped = 0;
+    // cqes lost by the kernel for the cq ring being full
+    uint64_t cq_overflow = 0;
+
+    [[nodiscard]]
+    double cqe_per_poll() const noexcept {
+        return completion_polls ? double(cqe_reaped) / completion_polls : 0;
+    }
+
+    [[nodiscard]]
+    double sqe_per_syscall() const noexcept {
+        return submit_syscalls ? double(sqe_submitted) / submit_syscalls : 0;
+    }
+
+    [[nodiscard]]
+    double resumed_per_round() const noexcept {
+        return worker_rounds ? double(coroutines_resumed) / worker_rounds : 0;
+    }
+};
+
+} // namespace co_context
+
+namespace co_context::detail {
+
+/**
+ * @brief The counters behind io_context_metrics. Written only by the host
+ * thread, so that an update is a plain load and store. Any thread may take a
+ * snapshot.
+ */
+struct alignas(config::cache_line_size) metrics_counters {
+    using counter = std::atomic<uint64_t>;
+
+    counter sqe_submitted{0};
+    counter submit_syscalls{0};
+    counter sq_full_submits{0};
+    counter round_submits{0};
+    counter cqe_reaped{0};
+    counter completion_polls{0};
+    counter coroutines_resumed{0};
+    counter worker_rounds{0};
+    counter wait_count{0};
+    counter wait_ns{0};
+    counter ready_high_water{0};
+    counter speculative_hits{0};
+    counter speculative_misses{0};
+    counter sq_dropped{0};
+    counter cq_overflow{0};
+
+    // Called by the host thread only.
+    static void add(counter &c, uint64_t n) noexcept {
+        const uint64_t old = c.load(std::memory_order_relaxed);
+        c.store(old + n, std::memory_order_relaxed);
+    }
+
+    // Called by the host thread only.
+    static void raise(counter &c, uint64_t n) noexcept {
+        if (n > c.load(std::memory_order_relaxed)) {
+            c.store(n, std::memory_order_relaxed);
+        }
+    }
+
+    [[nodiscard]]
+    io_context_metrics snapshot() const noexcept {
+        constexpr auto relaxed = std::memory_order_relaxed;
+        return {
+            .sqe_submitted = sqe_submitted.load(relaxed),
+            .submit_syscalls = submit_syscalls.load(relaxed),
+            .sq_full_submits = sq_full_submits.load(relaxed),
+            .round_submits = round_submits.load(relaxed),
+            .cqe_reaped = cqe_reaped.load(relaxed),
+            .completion_polls = completion_polls.load(relaxed),
+            .coroutines_resumed = coroutines_resumed.load(relaxed),
+            .worker_rounds = worker_rounds.load(relaxed),
+            .wait_count = wait_count.load(relaxed),
+            .wait_ns = wait_ns.load(relaxed),
+            .ready_high_water = ready_high_water.load(relaxed),
+            .speculative_hits = speculative_hits.load(relaxed),
+            .speculative_misses = speculative_misses.load(relaxed),
+            .sq_dropped = sq_dropped.load(relaxed),
+            .cq_overflow = cq_overflow.load(relaxed),
+        };
+    }
+};
+
+} // namespace co_context::detail
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <co_context/config/io_context.hpp>
+#include <co_context/config/net.hpp>
+#include <co_context/config/uring.hpp>
+
+#include <uring/io_uring.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace co_context {
+
+/**
+ * @brief Options of an io_context, fixed at construction.
+ */
+struct io_context_options {
+    /**
+     * @brief Flags passed to io_uring_setup, in addition to
+     * `config::io_uring_setup_flags`.
+     * @note Flags rejected by the kernel are dropped with a warning, in the
+     * order of DEFER_TASKRUN, SINGLE_ISSUER, COOP_TASKRUN, SQ_AFF and SQPOLL.
+     */
+    unsigned setup_flags = config::default_io_uring_setup_flags;
+
+    /**
+     * @brief Idle time in milliseconds before the SQPOLL thread sleeps.
+     * 0 means the default of the kernel. Only used with SQPOLL.
+     */
+    unsigned sq_thread_idle = 0;
+
+    /**
+     * @brief CPU to pin the SQPOLL thread, or -1 for no pinning. Only used
+     * with SQPOLL.
+     */
+    int sq_thread_cpu = -1;
+
+    /**
+     * @brief Enable IORING_SETUP_COOP_TASKRUN and IORING_SETUP_TASKRUN_FLAG,
+     * which is ignored under SQPOLL.
+     */
+    bool coop_taskrun = config::default_coop_taskrun;
+
+    /**
+     * @brief Upper bound of the time in nanoseconds to busy-poll the cq
+     * before blocking in io_uring_enter. The actual budget adapts to the
+     * recent idle gaps. 0 disables spinning.
+     */
+    uint32_t max_spin_ns = 0;
+
+    /**
+     * @brief Submit within a round of resuming ready coroutines, once this
+     * many sqes are pending. -1U waits until the round ends.
+     */
+    uint32_t submit_batch_max = config::submission_threshold;
+
+    /**
+     * @brief Bound in nanoseconds of how long an sqe waits within a round
+     * before it is submitted. The number of coroutines resumed between
+     * submits adapts to their measured cost. 0 waits until the round ends.
+     */
+    uint32_t submit_budget_ns = 0;
+
+    /**
+     * @brief Capacity of the normal lane of the ready queue, rounded up to a
+     * power of two. The high and low lanes get a fraction of it, see
+     * `config::minor_lane_capacity_divisor`. Ready coroutines beyond it
+     * spill into a growable area.
+     */
+    uint32_t swap_capacity = config::swap_capacity;
+
+    /**
+     * @brief Number of sqes of the ring. 0 means twice the swap_capacity,
+     * rounded up to a power of two. At most `max_uring_entries`, and larger
+     * values are clamped.
+     */
+    uint32_t io_uring_entries = 0;
+
+    /**
+     * @brief Number of buffers registered to the ring, lent by
+     * `io_context::fixed_buffers()`. 0 disables the pool. At most 16384.
+     */
+    uint32_t fixed_buffer_num = 0;
+
+    // Bytes of each registered buffer.
+    uint32_t fixed_buffer_size = 64 * 1024;
+
+    /**
+     * @brief Back the registered buffers by 2 MiB huge pages, which must be
+     * reserved in /proc/sys/vm/nr_hugepages. Falls back to normal pages.
+     */
+    bool fixed_buffer_huge_pages = false;
+
+    /**
+     * @brief Slots of the file table registered to the ring, which holds the
+     * direct descriptors of direct_socket and accept_direct_stream(). 0
+     * disables the table. Needs linux 5.19.
+     */
+    uint32_t fixed_file_num = 0;
+
+    /**
+     * @brief Payloads smaller than this are copied by socket::send_zc(). The
+     * break-even point depends on the NIC and the MTU, so measure it there.
+     */
+    uint32_t send_zc_min_bytes = config::send_zc_min_bytes;
+
+    /**
+     * @brief Options for a utility io_context (e.g. running timers only),
+     * which holds few coroutines and I/O requests at the same time.
+     */
+    [[nodiscard]]
+    static io_context_options compact() noexcept {
+        io_context_options options;
+        options.swap_capacity = 64;
+        options.io_uring_entries = 64;
+        return options;
+    }
+
+    /**
+     * @brief Options for a throughput-oriented io_context, which submits the
+     * sqes of all ready coroutines in one batch.
+     */
+    [[nodiscard]]
+    static io_context_options throughput() noexcept {
+        io_context_options options;
+        options.submit_batch_max = -1U;
+        options.submit_budget_ns = 0;
+        return options;
+    }
+
+    /**
+     * @brief Options for a latency-oriented io_context, which submits in
+     * small batches even if thousands of coroutines are ready.
+     */
+    [[nodiscard]]
+    static io_context_options latency() noexcept {
+        io_context_options options;
+        options.submit_batch_max = 32;
+        options.submit_budget_ns = 20'000;
+        return options;
+    }
+
+    /**
+     * @brief Options for a latency-critical io_context, whose submissions are
+     * polled by a kernel thread.
+     */
+    [[nodiscard]]
+    static io_context_options
+    sqpoll(unsigned idle_ms = 0, int cpu = -1) noexcept {
+        io_context_options options;
+        options.setup_flags = IORING_SETUP_SQPOLL;
+#if LIBURINGCXX_IS_KERNEL_REACH(6, 0)
+        options.setup_flags |= IORING_SETUP_SINGLE_ISSUER;
+#endif
+        options.sq_thread_idle = idle_ms;
+        options.sq_thread_cpu = cpu;
+        return options;
+    }
+
+    // The most sqes that the kernel accepts, i.e. IORING_MAX_ENTRIES.
+    static constexpr uint32_t max_uring_entries = 32768;
+
+    // The number of sqes to setup the ring.
+    [[nodiscard]]
+    uint32_t uring_entries() const noexcept {
+        const uint64_t entries = io_uring_entries != 0
+                                     ? uint64_t(io_uring_entries)
+                                     : std::max<uint64_t>(swap_capacity, 2) * 2;
+        return std::bit_ceil(
+            uint32_t(std::min<uint64_t>(entries, max_uring_entries))
+        );
+    }
+
+    /**
+     * @brief The flags to try first, combining all the options above.
+     */
+    [[nodiscard]]
+    unsigned uring_setup_flags() const noexcept {
+        unsigned flags = setup_flags | config::io_uring_setup_flags;
+        const bool is_sqpoll = flags & IORING_SETUP_SQPOLL;
+        if (coop_taskrun && !is_sqpoll) {
+            flags |= IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG;
+        }
+        if (is_sqpoll && sq_thread_cpu >= 0) {
+            flags |= IORING_SETUP_SQ_AFF;
+        }
+        return flags;
+    }
+};
+
+} // namespace co_context
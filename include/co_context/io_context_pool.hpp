@@ -0,0 +1,105 @@
+#pragma once
+
+#include <co_context/config/io_context.hpp>
+#include <co_context/io_context.hpp>
+#include <co_context/task.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace co_context {
+
+/**
+ * @brief A group of io_contexts, each of which is optionally pinned to some
+ * CPUs, so that their host threads will not migrate.
+ */
+class io_context_pool final {
+  public:
+    // How the io_contexts are pinned.
+    enum class placement : uint8_t {
+        // Do not pin.
+        none,
+        // One logical CPU per io_context.
+        per_cpu,
+        // One physical core per io_context, skipping the hyper-threads.
+        per_physical_core,
+        // All CPUs of a NUMA node per io_context.
+        per_numa_node,
+    };
+
+    /**
+     * @brief Create `size` io_contexts. If there are more io_contexts than
+     * CPUs (cores/nodes), they are placed round-robin.
+     * @pre size != 0, or the process terminates.
+     */
+    explicit io_context_pool(size_t size, placement how = placement::per_cpu);
+
+    /**
+     * @brief Create an io_context for each element of `cpus`, pinned to it.
+     * @pre !cpus.empty(), or the process terminates.
+     */
+    explicit io_context_pool(const std::vector<int> &cpus);
+
+    [[nodiscard]]
+    size_t size() const noexcept {
+        return ctx_num;
+    }
+
+    [[nodiscard]]
+    io_context &operator[](size_t i) noexcept {
+        return contexts[i];
+    }
+
+    // start all the io_contexts
+    void start();
+
+    // join all the io_contexts
+    void join();
+
+    // co_spawn on the i-th io_context.
+    void spawn_on(size_t i, task<void> &&entrance) noexcept;
+
+    // co_spawn on the io_context running the fewest tasks spawned by the pool.
+    void spawn_any(task<void> &&entrance) noexcept;
+
+    /**
+     * @brief Number of tasks that are spawned by the pool onto the i-th
+     * io_context and still running.
+     */
+    [[nodiscard]]
+    uint32_t load_of(size_t i) const noexcept {
+        return loads[i].value.load(std::memory_order_relaxed);
+    }
+
+    ~io_context_pool() noexcept = default;
+
+    /**
+     * ban all copying or moving
+     */
+    io_context_pool(const io_context_pool &) = delete;
+    io_context_pool(io_context_pool &&) = delete;
+    io_context_pool &operator=(const io_context_pool &) = delete;
+    io_context_pool &operator=(io_context_pool &&) = delete;
+
+  private:
+    struct alignas(config::cache_line_size) load_counter {
+        std::atomic<uint32_t> value{0};
+    };
+
+    static task<void>
+    counted(task<void> entrance, std::atomic<uint32_t> &load);
+
+    void place(placement how);
+
+  private:
+    size_t ctx_num;
+    std::unique_ptr<io_context[]> contexts;
+    std::unique_ptr<load_counter[]> loads;
+    // where spawn_any() starts scanning, to break ties
+    std::atomic<uint32_t> turn{0};
+};
+
+} // namespace co_context
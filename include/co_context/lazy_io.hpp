@@ -2,6 +2,7 @@
 
 #include <co_context/detail/attributes.hpp>
 #include <co_context/detail/lazy_io_awaiter.hpp>
+#include <co_context/fixed_buffer.hpp>
 
 namespace co_context {
 
@@ -69,6 +70,17 @@ inline namespace lazy {
         return detail::lazy_read_fixed{fd, buf, offset, buf_index};
     }
 
+    /**
+     * @brief Read into a leased buffer, see io_context::fixed_buffers().
+     * @pre Awaited on the io_context owning the lease.
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    inline detail::lazy_read_fixed
+    read_fixed(int fd, const fixed_buffer &buf, uint64_t offset) noexcept {
+        assert(buf && "read_fixed() with an empty lease");
+        return detail::lazy_read_fixed{fd, buf.span(), offset, buf.index()};
+    }
+
     [[CO_CONTEXT_AWAIT_HINT]]
     inline detail::lazy_writev writev(
         int fd, std::span<const iovec> iovecs, uint64_t offset = -1ULL
@@ -83,6 +95,22 @@ inline namespace lazy {
         return detail::lazy_write_fixed{fd, buf, offset, buf_index};
     }
 
+    /**
+     * @brief Write the first `nbytes` of a leased buffer, see
+     * io_context::fixed_buffers().
+     * @pre Awaited on the io_context owning the lease.
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    inline detail::lazy_write_fixed write_fixed(
+        int fd, const fixed_buffer &buf, size_t nbytes, uint64_t offset
+    ) noexcept {
+        assert(buf && "write_fixed() with an empty lease");
+        assert(nbytes <= buf.size());
+        return detail::lazy_write_fixed{
+            fd, buf.span().first(nbytes), offset, buf.index()
+        };
+    }
+
     [[CO_CONTEXT_AWAIT_HINT]]
     inline detail::lazy_recvmsg
     recvmsg(int fd, msghdr *msg, unsigned int flags) noexcept {
@@ -270,6 +298,14 @@ inline namespace lazy {
         return detail::lazy_accept_direct{fd, addr, addrlen, flags, file_index};
     }
 
+    // Accept into a free slot of the file table.
+    [[CO_CONTEXT_AWAIT_HINT]]
+    inline detail::lazy_accept_direct_alloc accept_direct_alloc(
+        int fd, sockaddr *addr, socklen_t *addrlen, int flags
+    ) noexcept {
+        return detail::lazy_accept_direct_alloc{fd, addr, addrlen, flags};
+    }
+
 #if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
     [[CO_CONTEXT_AWAIT_HINT]]
     inline detail::lazy_multishot_accept multishot_accept(
@@ -387,6 +423,10 @@ inline namespace lazy {
         return detail::lazy_send{sockfd, buf, flags};
     }
 
+    /**
+     * @note The kernel may read `buf` after completion, with no signal. See
+     * the overload with a zc_notification.
+     */
     [[CO_CONTEXT_AWAIT_HINT]]
     inline detail::lazy_send_zc send_zc(
         int sockfd, std::span<const char> buf, int flags, unsigned zc_flags
@@ -420,6 +460,10 @@ inline namespace lazy {
     }
 
 #if LIBURINGCXX_IS_KERNEL_REACH(5, 20)
+    /**
+     * @note Only the first cqe is awaited. To receive every message, see
+     * socket::recv_multishot().
+     */
     [[CO_CONTEXT_AWAIT_HINT]]
     inline detail::lazy_recv_multishot
     recv_multishot(int sockfd, std::span<char> buf, int flags = 0) noexcept {
@@ -641,6 +685,15 @@ inline namespace lazy {
         return detail::lazy_resume_on{resume_context};
     }
 
+    /**
+     * @brief Move the running coroutine to another priority lane. It takes
+     * effect since its next suspension.
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    inline detail::lazy_set_priority set_priority(priority prio) noexcept {
+        return detail::lazy_set_priority{prio};
+    }
+
 } // namespace lazy
 
 } // namespace co_context
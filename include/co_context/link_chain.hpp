@@ -0,0 +1,115 @@
+#pragma once
+
+#include <co_context/detail/attributes.hpp>
+#include <co_context/detail/lazy_io_awaiter.hpp>
+#include <co_context/detail/task_info.hpp>
+#include <co_context/detail/thread_meta.hpp>
+#include <co_context/detail/user_data.hpp>
+#include <co_context/detail/worker_meta.hpp>
+
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace co_context {
+
+/**
+ * @brief Links a number of lazy_io known only at runtime, like `&&` does for
+ * a fixed number, e.g. a write per fragment followed by an fsync. Awaiting
+ * the chain resumes once on the last step, and each step keeps its result.
+ * If a step fails, the following ones are canceled with -ECANCELED.
+ * @note Push the steps and await the chain with no other co_await in
+ * between, as with `&&`, and build one chain at a time. The chain is kept
+ * out of any early submission, so it must fit in the sq ring. Keep the
+ * chain alive until it is resumed.
+ */
+class link_chain final {
+  public:
+    link_chain() noexcept = default;
+
+    link_chain(const link_chain &) = delete;
+    link_chain &operator=(const link_chain &) = delete;
+
+    /**
+     * @brief Append a step, e.g. `chain.push(lazy::write(fd, buf, offset))`.
+     * Its result is kept by the chain, not by the awaiter.
+     * @note Only a plain awaiter is taken, since the awaiter is gone before
+     * the step completes. Await the others alone, e.g. send_zc() or a recv
+     * from a buffer_group.
+     */
+    template<detail::plain_awaiter Io>
+    link_chain &push(Io &&io) {
+        assert(!is_awaited && "push() after the chain is awaited");
+        assert(
+            io.sqe->get_data()
+                == (io.io_info.as_user_data()
+                    | uint64_t(detail::user_data_type::task_info_ptr))
+            && "push() of an awaiter whose cqe goes elsewhere"
+        );
+        if (last_sqe != nullptr) {
+            detail::set_link_sqe(last_sqe);
+        }
+        io.stamp_opcode();
+        detail::task_info &step = steps.emplace_back(io.io_info);
+        io.sqe->set_data(
+            step.as_user_data()
+            | uint64_t(detail::user_data_type::task_info_ptr)
+        );
+        last_sqe = io.sqe;
+        return *this;
+    }
+
+    [[nodiscard]]
+    size_t size() const noexcept {
+        return steps.size();
+    }
+
+    [[nodiscard]]
+    bool empty() const noexcept {
+        return steps.empty();
+    }
+
+    // The result of the i-th step, valid once the chain is resumed.
+    [[nodiscard]]
+    int32_t result(size_t i) const noexcept {
+        assert(i < steps.size());
+        return steps[i].result;
+    }
+
+    [[nodiscard]]
+    bool await_ready() const noexcept {
+        return steps.empty();
+    }
+
+    void await_suspend(std::coroutine_handle<> current) noexcept {
+        is_awaited = true;
+        steps.back().handle = current;
+        detail::trace(
+            detail::trace_event::suspend_io, current, last_sqe->get_opcode()
+        );
+    }
+
+    // The result of the last step, or 0 if the chain is empty.
+    /*NOLINT*/ int32_t await_resume() const noexcept {
+        if (steps.empty()) {
+            return 0;
+        }
+        const detail::task_info &last = steps.back();
+#if CO_CONTEXT_USE_LATENCY_HISTOGRAM
+        detail::this_thread.worker->latency.record_in_queue(
+            last.opcode, detail::latency_clock_ns() - last.complete_ns
+        );
+#endif
+        return last.result;
+    }
+
+  private:
+    // A deque keeps each step in place, where its cqe is written to.
+    std::deque<detail::task_info> steps;
+    liburingcxx::sq_entry *last_sqe = nullptr;
+    bool is_awaited = false;
+};
+
+} // namespace co_context
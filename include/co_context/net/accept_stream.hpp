@@ -0,0 +1,174 @@
+#pragma once
+
+#include <co_context/detail/attributes.hpp>
+#include <co_context/detail/multishot.hpp>
+#include <co_context/detail/thread_meta.hpp>
+#include <co_context/detail/worker_meta.hpp>
+#include <uring/utility/kernel_version.hpp>
+
+#include <cassert>
+#include <cerrno>
+#include <coroutine>
+#include <unistd.h>
+#include <utility>
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
+
+namespace co_context {
+
+namespace detail {
+
+    class accept_stream_state final : public multishot_state {
+      public:
+        accept_stream_state(int listen_fd, int flags, bool is_direct) noexcept
+            : listen_fd(listen_fd)
+            , flags(flags)
+            , is_direct(is_direct) {}
+
+        [[nodiscard]]
+        int take() noexcept {
+            return pop().res;
+        }
+
+      protected:
+        void prepare(liburingcxx::sq_entry &sqe) noexcept override {
+            // Without multishot, each request accepts one connection, and
+            // the stream arms it again.
+            if (!this_thread.worker->features.has_multishot_accept())
+                [[unlikely]] {
+                if (is_direct) {
+                    sqe.prep_accept_direct_alloc(
+                        listen_fd, nullptr, nullptr, flags
+                    );
+                } else {
+                    sqe.prep_accept(listen_fd, nullptr, nullptr, flags);
+                }
+                return;
+            }
+            if (is_direct) {
+                sqe.prep_multishot_accept_direct(
+                    listen_fd, nullptr, nullptr, flags
+                );
+            } else {
+                sqe.prep_multishot_accept(listen_fd, nullptr, nullptr, flags);
+            }
+        }
+
+        void discard(const multishot_cqe &cqe) noexcept override {
+            if (cqe.res < 0) {
+                return;
+            }
+            if (!is_direct) {
+                ::close(cqe.res);
+                return;
+            }
+            // The slot of the file table is freed by the ring. Not skipped,
+            // since a failed close posts its cqe anyway.
+            worker_meta *const worker = this_thread.worker;
+            liburingcxx::sq_entry *const sqe = worker->get_free_sqe();
+            sqe->prep_close_direct(unsigned(cqe.res));
+            sqe->set_data(uint64_t(reserved_user_data::nop));
+        }
+
+        // fd 0 is a connection, and a failed accept does not break the
+        // listening socket unless the socket itself is rejected.
+        [[nodiscard]]
+        bool is_final(int32_t res) const noexcept override {
+            switch (res) {
+                case -EBADF:
+                case -EINVAL:
+                case -ENOTSOCK:
+                case -EOPNOTSUPP:
+                case -ECANCELED:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+      private:
+        int listen_fd;
+        int flags;
+        bool is_direct;
+    };
+
+} // namespace detail
+
+/**
+ * @brief Accept connections by one multishot request, which yields an fd per
+ * connection without submitting a sqe each time. The request is armed by the
+ * first next(), and armed again if the kernel ends it early (e.g. on EMFILE).
+ * If the running kernel lacks multishot accept, it submits one request per
+ * connection instead, see uring_features.
+ * @note Not thread-safe. Use it on the thread of the io_context creating it,
+ * see io_context::set_work_stealing(). Connections accepted but not taken
+ * are closed on destruction of the stream.
+ */
+class [[nodiscard]] accept_stream final {
+  public:
+    /**
+     * @param is_direct Accept into direct descriptors, allocated from the
+     * file table of the ring. Without a table, each next() fails with
+     * -ENFILE.
+     */
+    accept_stream(int listen_fd, int flags = 0, bool is_direct = false)
+        : state(new detail::accept_stream_state{listen_fd, flags, is_direct}) {
+    }
+
+    accept_stream(accept_stream &&other) noexcept
+        : state(std::exchange(other.state, nullptr)) {}
+
+    accept_stream &operator=(accept_stream &&other) noexcept {
+        if (this != &other) {
+            reset();
+            state = std::exchange(other.state, nullptr);
+        }
+        return *this;
+    }
+
+    accept_stream(const accept_stream &) = delete;
+    accept_stream &operator=(const accept_stream &) = delete;
+
+    // Cancel the request if it is armed.
+    ~accept_stream() noexcept { reset(); }
+
+    struct next_awaiter {
+        detail::accept_stream_state &state;
+
+        [[nodiscard]]
+        bool await_ready() const noexcept {
+            return state.is_ready();
+        }
+
+        void await_suspend(std::coroutine_handle<> current) noexcept {
+            state.suspend(current, detail::this_thread.worker->current_priority);
+        }
+
+        int await_resume() noexcept { return state.take(); }
+    };
+
+    /**
+     * @brief Wait for the next connection.
+     * @return the fd (or the direct descriptor), or -errno. Transient errors
+     * such as -EMFILE do not end the stream. After a final error, the same
+     * error is returned by each next().
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    next_awaiter next() noexcept {
+        assert(state != nullptr);
+        return {*state};
+    }
+
+  private:
+    void reset() noexcept {
+        if (state != nullptr) {
+            std::exchange(state, nullptr)->abandon();
+        }
+    }
+
+    detail::accept_stream_state *state;
+};
+
+} // namespace co_context
+
+#endif
@@ -1,6 +1,10 @@
 #pragma once
+#include <co_context/net/accept_stream.hpp>
+#include <co_context/net/direct_socket.hpp>
 #include <co_context/net/socket.hpp>
 
+#include <fcntl.h>
+
 #include <memory>
 
 namespace co_context {
@@ -20,6 +24,55 @@ class acceptor {
         return lazy::accept(listen_socket.fd(), nullptr, nullptr, flags);
     }
 
+    /**
+     * @brief Accept by a non-blocking accept4() first, and submit a sqe only
+     * if no connection is pending, see socket::recv_speculative().
+     * @note It makes the listening socket non-blocking, which io_uring
+     * ignores by polling the socket. Accepted sockets are still blocking.
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto accept_speculative(int flags = 0) {
+        if (!is_non_blocking) [[unlikely]] {
+            const int fd = listen_socket.fd();
+            [[maybe_unused]] const int res =
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+            assert(res == 0);
+            is_non_blocking = true;
+        }
+        return detail::speculative_awaiter<detail::speculative_accept>{
+            listen_socket.spec, listen_socket.fd(), flags
+        };
+    }
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
+    /**
+     * @brief Accept a connection into a free slot of the file table, see
+     * direct_socket.
+     * @return an awaiter whose result is the slot, or -errno.
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto accept_direct(int flags = 0) noexcept {
+        return lazy::accept_direct_alloc(
+            listen_socket.fd(), nullptr, nullptr, flags
+        );
+    }
+
+    /**
+     * @brief Accept connections by one multishot request, see accept_stream.
+     * Nothing is submitted until the first `co_await stream.next()`.
+     */
+    [[nodiscard]]
+    co_context::accept_stream accept_stream(int flags = 0) const {
+        return co_context::accept_stream{listen_socket.fd(), flags};
+    }
+
+    // Same as accept_stream(), but yields direct descriptors.
+    [[nodiscard]]
+    co_context::accept_stream accept_direct_stream(int flags = 0) const {
+        return co_context::accept_stream{listen_socket.fd(), flags, true};
+    }
+#endif
+
     [[nodiscard]]
     int listen_fd() const noexcept {
         return listen_socket.fd();
@@ -29,6 +82,7 @@ class acceptor {
 
   private:
     socket listen_socket;
+    bool is_non_blocking = false;
 };
 
 inline acceptor::acceptor(const inet_address &listen_addr)
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <co_context/buffer_group.hpp>
+#include <co_context/lazy_io.hpp>
+#include <co_context/net/inet_address.hpp>
+#include <co_context/net/recv_stream.hpp>
+#include <co_context/zero_copy.hpp>
+#include <uring/utility/kernel_version.hpp>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
+
+namespace co_context {
+
+/**
+ * @brief A socket held by a direct descriptor, i.e. a slot of the file table
+ * of an io_context, see `io_context_options::fixed_file_num`. Its requests
+ * skip the lookup and refcounting of the file, and never touch the fd table
+ * shared by threads.
+ * @note The slot is only meaningful to the ring of the io_context creating
+ * the socket, so use the socket on that thread. Like socket, it is not
+ * closed on destruction.
+ */
+class direct_socket {
+  public:
+    explicit direct_socket(int file_index) noexcept
+        : file_index(file_index)
+        , owner(detail::this_thread.worker) {
+        assert(file_index >= 0);
+        assert(owner != nullptr);
+    }
+
+    ~direct_socket() noexcept = default;
+
+    direct_socket(direct_socket &&other) noexcept
+        : file_index(std::exchange(other.file_index, -1))
+        , owner(other.owner) {}
+
+    direct_socket &operator=(direct_socket &&other) noexcept {
+        assert(this != std::addressof(other));
+        file_index = std::exchange(other.file_index, -1);
+        owner = other.owner;
+        return *this;
+    }
+
+    // The slot in the file table.
+    [[nodiscard]]
+    int index() const noexcept {
+        return file_index;
+    }
+
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto connect(const inet_address &addr) const noexcept {
+        return detail::lazy_direct<detail::lazy_connect>{
+            slot(), addr.get_sockaddr(), addr.length()
+        };
+    }
+
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto recv(std::span<char> buf, int flags = 0) const noexcept {
+        return detail::lazy_direct<detail::lazy_recv>{slot(), buf, flags};
+    }
+
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto send(std::span<const char> buf, int flags = 0) const noexcept {
+        return detail::lazy_direct<detail::lazy_send>{slot(), buf, flags};
+    }
+
+    // See socket::recv(buffer_group &, int).
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto recv(buffer_group &group, int flags = 0) const noexcept {
+        return detail::lazy_direct<detail::lazy_recv_select>{
+            group, slot(), flags
+        };
+    }
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 20)
+    // See socket::recv_multishot().
+    [[nodiscard]]
+    recv_stream recv_multishot(buffer_group &group, int flags = 0) const {
+        return recv_stream{slot(), group, flags, true};
+    }
+#endif
+
+    // See socket::recv(const fixed_buffer &).
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto recv(const fixed_buffer &buf) const noexcept {
+        assert(buf && "recv() with an empty lease");
+        return detail::lazy_direct<detail::lazy_read_fixed>{
+            slot(), buf.span(), 0, buf.index()
+        };
+    }
+
+    // See socket::send(const fixed_buffer &, size_t).
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto send(const fixed_buffer &buf, size_t nbytes) const noexcept {
+        assert(buf && "send() with an empty lease");
+        assert(nbytes <= buf.size());
+        return detail::lazy_direct<detail::lazy_write_fixed>{
+            slot(), buf.span().first(nbytes), 0, buf.index()
+        };
+    }
+
+#if LIBURINGCXX_IS_KERNEL_REACH(6, 0)
+    // See socket::send_zc(std::span<const char>, zc_notification &, int).
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto send_zc(
+        std::span<const char> buf, zc_notification &notif, int flags = 0
+    ) const noexcept {
+        return detail::lazy_direct<detail::lazy_send_zc_notified>{
+            slot(), buf, flags, notif,
+            detail::is_zero_copy_send(buf.size())
+        };
+    }
+
+    // See socket::send_zc(fixed_buffer &&, size_t, int).
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto send_zc(fixed_buffer &&buf, size_t nbytes, int flags = 0)
+        const noexcept {
+        return detail::lazy_direct<detail::lazy_send_zc_lease>{
+            slot(), std::move(buf), nbytes, flags
+        };
+    }
+#endif
+
+    /**
+     * @brief Close the socket and free the slot.
+     * @pre The socket holds a slot, i.e. it is not moved from or closed.
+     * Otherwise, the result is -EINVAL.
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto close() noexcept {
+        assert(file_index >= 0 && "close() a direct_socket holding no slot");
+        assert(is_on_owner() && "a direct_socket out of its io_context");
+        // unsigned(-1) + 1 would wrap to 0, i.e. close(0) on the fd table.
+        constexpr unsigned no_slot = UINT32_MAX - 1;
+        const int index = std::exchange(file_index, -1);
+        return lazy::close_direct(index >= 0 ? unsigned(index) : no_slot);
+    }
+
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto shutdown_write() const noexcept {
+        return detail::lazy_direct<detail::lazy_shutdown>{slot(), SHUT_WR};
+    }
+
+    /**
+     * @brief Create a TCP socket in a free slot.
+     * @return an awaiter whose result is the slot, or -errno.
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    static auto create_tcp(sa_family_t family) noexcept {
+        return lazy::make_socket_direct_alloc(
+            family, SOCK_STREAM, IPPROTO_TCP, 0
+        );
+    }
+
+  private:
+    // false on a thief of a work-stealing io_context, see set_work_stealing().
+    [[nodiscard]]
+    bool is_on_owner() const noexcept {
+        return owner == detail::this_thread.worker;
+    }
+
+    // The slot for a request, on the ring owning it.
+    [[nodiscard]]
+    int slot() const noexcept {
+        assert(is_on_owner() && "a direct_socket out of its io_context");
+        return file_index;
+    }
+
+    int file_index;
+    // The worker whose file table holds the slot.
+    detail::worker_meta *owner;
+};
+
+} // namespace co_context
+
+#endif
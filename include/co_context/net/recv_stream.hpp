@@ -0,0 +1,173 @@
+#pragma once
+
+#include <co_context/buffer_group.hpp>
+#include <co_context/detail/attributes.hpp>
+#include <co_context/detail/multishot.hpp>
+#include <co_context/detail/thread_meta.hpp>
+#include <co_context/detail/worker_meta.hpp>
+#include <uring/utility/kernel_version.hpp>
+
+#include <cassert>
+#include <coroutine>
+#include <utility>
+#include <vector>
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 20)
+
+namespace co_context {
+
+namespace detail {
+
+    class recv_stream_state final : public multishot_state {
+      public:
+        recv_stream_state(
+            int sockfd, buffer_group &group, int flags, bool is_direct
+        ) noexcept
+            : group(group)
+            , sockfd(sockfd)
+            , flags(flags)
+            , is_direct(is_direct) {}
+
+        ~recv_stream_state() noexcept override {
+            if (is_starved) {
+                std::erase(group.starved, this);
+            }
+        }
+
+        // Called by the group once a buffer is back.
+        void on_buffer_back() noexcept {
+            is_starved = false;
+            rearm();
+        }
+
+        [[nodiscard]]
+        provided_buffer take() noexcept {
+            const multishot_cqe cqe = pop();
+            return group.take(cqe.res, cqe.flags);
+        }
+
+      protected:
+        void prepare(liburingcxx::sq_entry &sqe) noexcept override {
+            // Without multishot, each request receives one message, and the
+            // stream arms it again.
+            // A multishot recv takes the length of each selected buffer.
+            if (this_thread.worker->features.has_multishot_recv()) [[likely]] {
+                sqe.prep_recv_multishot(sockfd, {}, flags);
+                sqe.set_buffer_select(group.id());
+            } else {
+                sqe.prep_recv_select(
+                    sockfd, group.buffer_bytes(), flags, group.id()
+                );
+            }
+            if (is_direct) {
+                sqe.set_fixed_file();
+            }
+        }
+
+        void discard(const multishot_cqe &cqe) noexcept override {
+            // The buffer goes back to the group at once.
+            (void)group.take(cqe.res, cqe.flags);
+        }
+
+        bool wait_for_buffer() noexcept override {
+            if (group.has_buffer()) {
+                // Released before this cqe is handled, so no wake-up follows.
+                rearm();
+                return true;
+            }
+            if (!is_starved) {
+                is_starved = true;
+                group.starved.push_back(this);
+            }
+            return true;
+        }
+
+      private:
+        buffer_group &group;
+        int sockfd;
+        int flags;
+        bool is_direct;
+        bool is_starved = false;
+    };
+
+} // namespace detail
+
+/**
+ * @brief Receive from a socket by one multishot request, which yields a
+ * provided_buffer per message without submitting a sqe each time. The
+ * request is armed by the first next(), and armed again if the kernel ends
+ * it early (e.g. the group runs out of buffers).
+ * If the running kernel lacks multishot recv, it submits one request per
+ * message instead, see uring_features.
+ * @note Not thread-safe. Use it on the thread of the io_context creating it,
+ * see io_context::set_work_stealing(), and keep the buffer_group alive until
+ * the request ends, even after destruction of the stream.
+ */
+class [[nodiscard]] recv_stream final {
+  public:
+    /**
+     * @param is_direct `sockfd` is a direct descriptor, see direct_socket.
+     */
+    recv_stream(
+        int sockfd, buffer_group &group, int flags = 0, bool is_direct = false
+    )
+        : state(new detail::recv_stream_state{sockfd, group, flags, is_direct}
+        ) {}
+
+    recv_stream(recv_stream &&other) noexcept
+        : state(std::exchange(other.state, nullptr)) {}
+
+    recv_stream &operator=(recv_stream &&other) noexcept {
+        if (this != &other) {
+            reset();
+            state = std::exchange(other.state, nullptr);
+        }
+        return *this;
+    }
+
+    recv_stream(const recv_stream &) = delete;
+    recv_stream &operator=(const recv_stream &) = delete;
+
+    // Cancel the request if it is armed.
+    ~recv_stream() noexcept { reset(); }
+
+    struct next_awaiter {
+        detail::recv_stream_state &state;
+
+        [[nodiscard]]
+        bool await_ready() const noexcept {
+            return state.is_ready();
+        }
+
+        void await_suspend(std::coroutine_handle<> current) noexcept {
+            state.suspend(current, detail::this_thread.worker->current_priority);
+        }
+
+        provided_buffer await_resume() noexcept { return state.take(); }
+    };
+
+    /**
+     * @brief Wait for the next message.
+     * @return a provided_buffer, whose result() is the bytes received, or 0
+     * on EOF, or -errno. After EOF or an error, the same result is returned
+     * by each next().
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    next_awaiter next() noexcept {
+        assert(state != nullptr);
+        return {*state};
+    }
+
+  private:
+    void reset() noexcept {
+        if (state != nullptr) {
+            std::exchange(state, nullptr)->abandon();
+        }
+    }
+
+    detail::recv_stream_state *state;
+};
+
+} // namespace co_context
+
+#endif
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <co_context/buffer_group.hpp>
+#include <co_context/detail/speculation.hpp>
 #include <co_context/lazy_io.hpp>
 #include <co_context/net/inet_address.hpp>
+#include <co_context/net/recv_stream.hpp>
+#include <co_context/zero_copy.hpp>
 
 #include <netinet/in.h>
 #include <netinet/tcp.h>
@@ -21,7 +25,7 @@ class socket {
     // TODO check if ~socket() need `close(sockfd)`
     ~socket() noexcept = default;
 
-    socket(socket &&other) noexcept {
+    socket(socket &&other) noexcept : spec(other.spec) {
         sockfd = other.sockfd;
         other.sockfd = -1;
     }
@@ -29,6 +33,7 @@ class socket {
     socket &operator=(socket &&other) noexcept {
         assert(this != std::addressof(other));
         sockfd = other.sockfd;
+        spec = other.spec;
         other.sockfd = -1;
         return *this;
     }
@@ -37,6 +42,7 @@ class socket {
         const int tmp = sockfd;
         sockfd = other.sockfd;
         other.sockfd = tmp;
+        std::swap(spec, other.spec);
     }
 
     [[nodiscard]]
@@ -73,6 +79,93 @@ class socket {
         return lazy::send(sockfd, buf, flags);
     }
 
+    /**
+     * @brief Receive by a non-blocking recv() first, and submit a sqe only if
+     * no data is buffered yet. This saves the round trip through the ring
+     * when the peer pipelines its requests. The socket stops trying while
+     * most tries would block, then tries again after a while.
+     * @note Not linkable by `&&`. With MSG_WAITALL, it is the same as recv().
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto recv_speculative(std::span<char> buf, int flags = 0) noexcept {
+        return detail::speculative_awaiter<detail::speculative_recv>{
+            spec, sockfd, buf, flags
+        };
+    }
+
+    // Send by a non-blocking send() first, see recv_speculative().
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto send_speculative(std::span<const char> buf, int flags = 0) noexcept {
+        return detail::speculative_awaiter<detail::speculative_send>{
+            spec, sockfd, buf, flags
+        };
+    }
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
+    /**
+     * @brief Receive into a buffer picked by the kernel from `group` once
+     * data arrives. The awaiter returns a provided_buffer.
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto recv(buffer_group &group, int flags = 0) const noexcept {
+        return group.recv(sockfd, flags);
+    }
+#endif
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 20)
+    /**
+     * @brief Receive messages by one multishot request, see recv_stream.
+     * Nothing is submitted until the first `co_await stream.next()`.
+     */
+    [[nodiscard]]
+    recv_stream recv_multishot(buffer_group &group, int flags = 0) const {
+        return recv_stream{sockfd, group, flags};
+    }
+#endif
+
+    /**
+     * @brief Receive into a leased buffer by read_fixed, sparing the kernel
+     * from pinning the pages per call. Flags are not supported.
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto recv(const fixed_buffer &buf) const noexcept {
+        return lazy::read_fixed(sockfd, buf, 0);
+    }
+
+    // Send the first `nbytes` of a leased buffer by write_fixed.
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto send(const fixed_buffer &buf, size_t nbytes) const noexcept {
+        return lazy::write_fixed(sockfd, buf, nbytes, 0);
+    }
+
+#if LIBURINGCXX_IS_KERNEL_REACH(6, 0)
+    /**
+     * @brief Send by zero copy, or by a copy if `buf` is smaller than
+     * `io_context_options::send_zc_min_bytes`. Resumes on the result. Reuse
+     * `buf` once `notif` is released.
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto send_zc(
+        std::span<const char> buf, zc_notification &notif, int flags = 0
+    ) const noexcept {
+        return detail::lazy_send_zc_notified{
+            sockfd, buf, flags, notif, detail::is_zero_copy_send(buf.size())
+        };
+    }
+
+    /**
+     * @brief Send the first `nbytes` of a lease by zero copy, or by a copy if
+     * small. The lease goes back to the pool once the kernel drops it.
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    auto send_zc(fixed_buffer &&buf, size_t nbytes, int flags = 0)
+        const noexcept {
+        return detail::lazy_send_zc_lease{
+            sockfd, std::move(buf), nbytes, flags
+        };
+    }
+#endif
+
     [[CO_CONTEXT_AWAIT_HINT]]
     auto close() noexcept {
         const int tmp = sockfd;
@@ -90,7 +183,12 @@ class socket {
     static socket create_udp(sa_family_t family); // AF_INET or AF_INET6
 
   private:
+    friend class acceptor;
+
     int sockfd;
+
+    // hit rate of recv_speculative() and the like
+    detail::speculation spec;
 };
 
 inline socket socket::create_tcp(sa_family_t family) {
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <co_context/detail/attributes.hpp>
+#include <co_context/detail/frame_pool.hpp>
 #include <co_context/detail/type_traits.hpp>
 #include <co_context/io_context.hpp>
 
@@ -70,6 +71,15 @@ class shared_task_promise_base {
         , waiters_(&this->waiters_)
         , exception_(nullptr) {}
 
+    // Frames are allocated from the pool of the current thread.
+    static void *operator new(std::size_t size) {
+        return frame_pool::allocate(size);
+    }
+
+    static void operator delete(void *ptr, std::size_t size) noexcept {
+        frame_pool::deallocate(ptr, size);
+    }
+
     constexpr std::suspend_always initial_suspend() noexcept { return {}; }
 
     final_awaiter final_suspend() noexcept { return {}; }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <co_context/detail/attributes.hpp>
+#include <co_context/detail/frame_pool.hpp>
 #include <co_context/detail/type_traits.hpp>
 
 #include <cassert>
@@ -79,6 +80,15 @@ namespace detail {
       public:
         task_promise_base() noexcept = default;
 
+        // Frames are allocated from the pool of the current thread.
+        static void *operator new(std::size_t size) {
+            return frame_pool::allocate(size);
+        }
+
+        static void operator delete(void *ptr, std::size_t size) noexcept {
+            frame_pool::deallocate(ptr, size);
+        }
+
         inline constexpr std::suspend_always initial_suspend() noexcept {
             return {};
         }
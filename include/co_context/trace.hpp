@@ -0,0 +1,38 @@
+#pragma once
+
+#include <co_context/config/config.hpp>
+
+#include <chrono>
+
+namespace co_context {
+
+/**
+ * @brief Start recording the lifecycle of coroutines on all io_contexts:
+ * spawn, resume, suspension on I/O (with the opcode), I/O completion and hops
+ * between io_contexts. A background thread flushes the records to a binary
+ * file every `flush_period`.
+ * @return false if tracing is running already, the file can not be opened,
+ * or co_context is built without the cmake option ENABLE_TRACE.
+ * @note Records are dropped while an io_context outruns the flusher, see
+ * `config::trace_buffer_capacity`.
+ */
+bool trace_start(
+    const char *binary_path,
+    std::chrono::milliseconds flush_period = std::chrono::milliseconds{10}
+);
+
+/**
+ * @brief Stop recording, flush the remaining records and close the file.
+ */
+void trace_stop() noexcept;
+
+/**
+ * @brief Convert a binary file of trace_start() into the Chrome trace JSON,
+ * which can be opened by Perfetto (ui.perfetto.dev) or chrome://tracing.
+ * Each io_context is shown as a thread.
+ * @return false if either file can not be opened, or the binary file is
+ * malformed.
+ */
+bool trace_to_chrome_json(const char *binary_path, const char *json_path);
+
+} // namespace co_context
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <uring/io_uring.h>
+
+#include <bitset>
+#include <cstdint>
+
+namespace co_context {
+
+/**
+ * @brief What the running kernel supports, probed once per ring on setup,
+ * see `io_context::features()`. The kernel version at build time decides
+ * which paths are compiled in, and this decides which of them are taken.
+ * Only multishot accept, multishot recv and zero-copy send are dispatched
+ * by it at runtime. msg_ring spawning and cqe skipping stay chosen at build
+ * time: a build for an older kernel never takes them, and a build for a
+ * newer one refuses to start on a kernel lacking them.
+ * @note Features without an opcode of their own are told by the opcode that
+ * came with them in the same release.
+ */
+struct uring_features {
+    // IORING_FEAT_* reported by io_uring_setup
+    uint32_t feature_bits = 0;
+
+    // IORING_SETUP_* of the ring, after the rejected ones are dropped
+    uint32_t setup_flags = 0;
+
+    // opcodes supported by the kernel, empty before linux 5.6
+    std::bitset<256> ops;
+
+    [[nodiscard]]
+    bool has_op(io_uring_op op) const noexcept {
+        return ops.test(op);
+    }
+
+    [[nodiscard]]
+    bool has_feature(uint32_t bit) const noexcept {
+        return (feature_bits & bit) != 0;
+    }
+
+    [[nodiscard]]
+    bool has_cqe_skip() const noexcept {
+        return has_feature(IORING_FEAT_CQE_SKIP);
+    }
+
+    [[nodiscard]]
+    bool has_msg_ring() const noexcept {
+        return has_op(IORING_OP_MSG_RING);
+    }
+
+    // Multishot accept came with IORING_OP_SOCKET in linux 5.19.
+    [[nodiscard]]
+    bool has_multishot_accept() const noexcept {
+        return has_op(IORING_OP_SOCKET);
+    }
+
+    // Multishot recv came with IORING_OP_SEND_ZC in linux 6.0.
+    [[nodiscard]]
+    bool has_multishot_recv() const noexcept {
+        return has_op(IORING_OP_SEND_ZC);
+    }
+
+    [[nodiscard]]
+    bool has_send_zc() const noexcept {
+        return has_op(IORING_OP_SEND_ZC);
+    }
+};
+
+} // namespace co_context
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <co_context/config/net.hpp>
+#include <co_context/detail/attributes.hpp>
+#include <co_context/detail/lazy_io_awaiter.hpp>
+#include <co_context/detail/task_info.hpp>
+#include <co_context/detail/user_data.hpp>
+#include <co_context/fixed_buffer.hpp>
+#include <uring/utility/kernel_version.hpp>
+
+#include <cassert>
+#include <coroutine>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+#if LIBURINGCXX_IS_KERNEL_REACH(6, 0)
+
+namespace co_context {
+
+namespace detail {
+
+    /**
+     * @brief The target of the cqes of zero-copy sends. Each send posts its
+     * result, then a notification once the kernel drops the buffer.
+     */
+    class zc_send_state {
+      public:
+        zc_send_state() noexcept = default;
+
+        zc_send_state(const zc_send_state &) = delete;
+        zc_send_state &operator=(const zc_send_state &) = delete;
+
+        // Route the cqes of `sqe` here, resuming `io_info` on the result.
+        void track(liburingcxx::sq_entry &sqe, task_info &io_info) noexcept {
+            assert(sending == nullptr && "one send in flight at a time");
+            sending = &io_info;
+            ++pending;
+            sqe.set_data(
+                uint64_t(reinterpret_cast<uintptr_t>(this))
+                | uint64_t(user_data_type::zero_copy)
+            );
+        }
+
+        // Called by handle_cq_entry(). `this` may be deleted.
+        void on_cqe(int32_t res, uint32_t flags) noexcept;
+
+      protected:
+        ~zc_send_state() noexcept = default;
+
+        // All tracked buffers are dropped by the kernel.
+        virtual void on_released() noexcept = 0;
+
+        // sends whose buffer may be read by the kernel
+        uint32_t pending = 0;
+
+      private:
+        task_info *sending = nullptr;
+    };
+
+    // A lease sent by zero copy, which goes back to the pool on release.
+    class zc_lease final : public zc_send_state {
+      public:
+        explicit zc_lease(fixed_buffer &&buf) noexcept : buf(std::move(buf)) {}
+
+        fixed_buffer buf;
+
+      protected:
+        void on_released() noexcept override { delete this; }
+    };
+
+    // Whether a send of `nbytes` goes by zero copy rather than by a copy.
+    [[nodiscard]]
+    inline bool is_zero_copy_send(size_t nbytes) noexcept {
+        const worker_meta &worker = *this_thread.worker;
+        return nbytes >= worker.send_zc_min_bytes
+               && worker.features.has_send_zc();
+    }
+
+    struct lazy_send_zc_notified : lazy_awaiter {
+        // Its cqes go to the zc_send_state, by the user_data.
+        static constexpr bool is_plain = false;
+
+        inline lazy_send_zc_notified(
+            int sockfd,
+            std::span<const char> buf,
+            int flags,
+            zc_send_state &state,
+            bool is_zero_copy
+        ) noexcept {
+            if (!is_zero_copy) {
+                sqe->prep_send(sockfd, buf, flags);
+                return;
+            }
+            sqe->prep_send_zc(sockfd, buf, flags, 0);
+            state.track(*sqe, io_info);
+        }
+    };
+
+    struct lazy_send_zc_lease : lazy_awaiter {
+        inline lazy_send_zc_lease(
+            int sockfd, fixed_buffer &&buf, size_t nbytes, int flags
+        ) noexcept {
+            assert(buf && "send_zc() with an empty lease");
+            assert(nbytes <= buf.size());
+            const std::span<const char> data = buf.span().first(nbytes);
+            if (!is_zero_copy_send(nbytes)) {
+                // Hold the lease until the copy is done.
+                sqe->prep_send(sockfd, data, flags);
+                copied = std::move(buf);
+                return;
+            }
+            auto *const lease = new zc_lease{std::move(buf)};
+            sqe->prep_send_zc_fixed(sockfd, data, flags, 0, lease->buf.index());
+            lease->track(*sqe, io_info);
+        }
+
+        fixed_buffer copied;
+    };
+
+} // namespace detail
+
+/**
+ * @brief Tells when the buffers of zero-copy sends tracked by it can be
+ * reused. A zero-copy send completes once the bytes are queued, but the
+ * kernel reads the buffer until the bytes are acknowledged.
+ * @note Not thread-safe. Use it on the thread of an io_context, and keep it
+ * alive until is_pending() is false. Not to be linked by `&&`.
+ */
+class zc_notification final : public detail::zc_send_state {
+  public:
+    zc_notification() noexcept = default;
+
+    ~zc_notification() noexcept {
+        assert(pending == 0 && "a buffer is still read by the kernel");
+    }
+
+    // Whether a tracked buffer may still be read by the kernel.
+    [[nodiscard]]
+    bool is_pending() const noexcept {
+        return pending != 0;
+    }
+
+    struct released_awaiter {
+        zc_notification &notif;
+
+        [[nodiscard]]
+        bool await_ready() const noexcept {
+            return !notif.is_pending();
+        }
+
+        void await_suspend(std::coroutine_handle<> current) noexcept {
+            assert(!notif.waiter && "one waiter at a time");
+            notif.waiter = current;
+            notif.waiter_prio = detail::this_thread.worker->current_priority;
+        }
+
+        constexpr void await_resume() const noexcept {}
+    };
+
+    // Wait until all tracked buffers can be reused.
+    [[CO_CONTEXT_AWAIT_HINT]]
+    released_awaiter released() noexcept {
+        return {*this};
+    }
+
+  protected:
+    void on_released() noexcept override;
+
+  private:
+    std::coroutine_handle<> waiter;
+    priority waiter_prio = priority::normal;
+};
+
+namespace lazy {
+
+    /**
+     * @brief Send by zero copy, resuming on the result like send(). The
+     * buffer must not be modified until `notif` is released. If the kernel
+     * lacks zero-copy sends, the buffer is copied.
+     */
+    [[CO_CONTEXT_AWAIT_HINT]]
+    inline detail::lazy_send_zc_notified send_zc(
+        int sockfd,
+        std::span<const char> buf,
+        zc_notification &notif,
+        int flags = 0
+    ) noexcept {
+        return detail::lazy_send_zc_notified{
+            sockfd, buf, flags, notif,
+            detail::this_thread.worker->features.has_send_zc()
+        };
+    }
+
+} // namespace lazy
+
+} // namespace co_context
+
+#endif
@@ -0,0 +1,125 @@
+#include <co_context/buffer_group.hpp>
+#include <co_context/detail/thread_meta.hpp>
+#include <co_context/detail/worker_meta.hpp>
+#include <co_context/net/recv_stream.hpp>
+
+#include <sys/mman.h>
+
+#include <bit>
+#include <cerrno>
+#include <system_error>
+#include <vector>
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
+
+namespace co_context {
+
+namespace {
+
+    // The kernel limits the entries of a buffer ring to 32768.
+    constexpr uint32_t max_buffer_num = 1U << 15;
+
+    // bgids are per ring, thus per thread.
+    struct buffer_group_ids {
+        std::vector<uint16_t> free_ids;
+        uint32_t create_count = 0;
+
+        uint16_t acquire() {
+            if (!free_ids.empty()) {
+                const uint16_t id = free_ids.back();
+                free_ids.pop_back();
+                return id;
+            }
+            if (create_count > UINT16_MAX) [[unlikely]] {
+                throw std::system_error{
+                    ENOSPC, std::system_category(), "buffer_group: bgid"
+                };
+            }
+            return uint16_t(create_count++);
+        }
+
+        void release(uint16_t id) { free_ids.push_back(id); }
+    };
+
+    thread_local buffer_group_ids group_ids; // NOLINT(*global-variables)
+
+    void *map_anonymous(size_t size) {
+        void *const addr = ::mmap(
+            nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+            -1, 0
+        );
+        if (addr == MAP_FAILED) [[unlikely]] {
+            throw std::system_error{
+                errno, std::system_category(), "buffer_group: mmap"
+            };
+        }
+        return addr;
+    }
+
+} // namespace
+
+buffer_group::buffer_group(uint32_t buffer_num, uint32_t buffer_size) {
+    assert(
+        detail::this_thread.worker != nullptr
+        && "buffer_group must be constructed on the thread of an io_context"
+    );
+    assert(buffer_num > 0 && buffer_num <= max_buffer_num);
+    assert(buffer_size > 0);
+
+    this->ring = &detail::this_thread.worker->ring;
+    this->buffer_num = std::bit_ceil(buffer_num);
+    this->buffer_size = buffer_size;
+    this->mask = liburingcxx::buf_ring::mask_of(this->buffer_num);
+    this->ring_size = sizeof(io_uring_buf) * this->buffer_num;
+    this->arena_size = size_t(this->buffer_num) * buffer_size;
+
+    this->br = static_cast<liburingcxx::buf_ring *>(map_anonymous(ring_size));
+    try {
+        this->arena = static_cast<char *>(map_anonymous(arena_size));
+    } catch (...) {
+        ::munmap(br, ring_size);
+        throw;
+    }
+    this->bgid = group_ids.acquire();
+
+    const int res = ring->register_buf_ring(br, this->buffer_num, bgid);
+    if (res < 0) [[unlikely]] {
+        group_ids.release(bgid);
+        ::munmap(arena, arena_size);
+        ::munmap(br, ring_size);
+        throw std::system_error{
+            -res, std::system_category(), "buffer_group: register_buf_ring"
+        };
+    }
+
+    br->init();
+    for (uint32_t i = 0; i < this->buffer_num; ++i) {
+        br->add(
+            buffer_at(uint16_t(i)), buffer_size, uint16_t(i), int(mask), int(i)
+        );
+    }
+    br->advance(int(this->buffer_num));
+}
+
+void buffer_group::wake_starved() noexcept {
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 20)
+    // All of them, since the one taking the buffer is the first to receive.
+    // Those finding the group empty again park again.
+    std::vector<detail::recv_stream_state *> streams;
+    streams.swap(starved);
+    for (detail::recv_stream_state *const stream : streams) {
+        stream->on_buffer_back();
+    }
+#endif
+}
+
+buffer_group::~buffer_group() noexcept {
+    ring->unregister_buf_ring(bgid);
+    group_ids.release(bgid);
+    ::munmap(arena, arena_size);
+    ::munmap(br, ring_size);
+}
+
+} // namespace co_context
+
+#endif
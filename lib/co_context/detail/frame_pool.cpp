@@ -0,0 +1,72 @@
+#include <co_context/detail/frame_pool.hpp>
+
+#include <mutex>
+#include <vector>
+
+namespace co_context::detail {
+
+namespace {
+
+    // Pools left by exited threads, waiting to be adopted.
+    struct orphan_list {
+        std::mutex mtx;
+        std::vector<frame_pool *> pools;
+    };
+
+    orphan_list &orphans() {
+        // Never destructed, since frames may be freed after main() returns.
+        static auto *const list = new orphan_list;
+        return *list;
+    }
+
+} // namespace
+
+// Abandon the pool of this thread on exit.
+struct frame_pool_releaser {
+    ~frame_pool_releaser() { frame_pool::abandon_local(); }
+};
+
+void frame_pool::reclaim_remote() noexcept {
+    free_block *block =
+        remote_frees.exchange(nullptr, std::memory_order_acquire);
+    while (block != nullptr) {
+        free_block *const next = block->next;
+        free_local(header_of(block));
+        ++counters.remote_free_count;
+        block = next;
+    }
+}
+
+frame_pool &frame_pool::acquire_local() {
+    thread_local frame_pool_releaser releaser;
+    (void)releaser;
+
+    frame_pool *pool = nullptr;
+    {
+        auto &list = orphans();
+        std::lock_guard lg{list.mtx};
+        if (!list.pools.empty()) {
+            pool = list.pools.back();
+            list.pools.pop_back();
+        }
+    }
+    if (pool == nullptr) {
+        pool = new frame_pool;
+    }
+    local_pool = pool;
+    return *pool;
+}
+
+void frame_pool::abandon_local() noexcept {
+    frame_pool *const pool = local_pool;
+    if (pool == nullptr) {
+        return;
+    }
+    // Frames freed from now on are returned to the pool as a remote thread.
+    local_pool = nullptr;
+    auto &list = orphans();
+    std::lock_guard lg{list.mtx};
+    list.pools.push_back(pool);
+}
+
+} // namespace co_context::detail
@@ -0,0 +1,93 @@
+#include <co_context/detail/latency_histogram.hpp>
+
+#include <cinttypes>
+#include <cstdio>
+
+namespace co_context::detail {
+
+const char *latency_stats::op_name(uint8_t opcode) noexcept {
+    switch (opcode) {
+        case IORING_OP_NOP:
+            return "nop";
+        case IORING_OP_READV:
+            return "readv";
+        case IORING_OP_WRITEV:
+            return "writev";
+        case IORING_OP_FSYNC:
+            return "fsync";
+        case IORING_OP_READ_FIXED:
+            return "read_fixed";
+        case IORING_OP_WRITE_FIXED:
+            return "write_fixed";
+        case IORING_OP_POLL_ADD:
+            return "poll_add";
+        case IORING_OP_SENDMSG:
+            return "sendmsg";
+        case IORING_OP_RECVMSG:
+            return "recvmsg";
+        case IORING_OP_TIMEOUT:
+            return "timeout";
+        case IORING_OP_ACCEPT:
+            return "accept";
+        case IORING_OP_ASYNC_CANCEL:
+            return "cancel";
+        case IORING_OP_CONNECT:
+            return "connect";
+        case IORING_OP_OPENAT:
+            return "openat";
+        case IORING_OP_CLOSE:
+            return "close";
+        case IORING_OP_STATX:
+            return "statx";
+        case IORING_OP_READ:
+            return "read";
+        case IORING_OP_WRITE:
+            return "write";
+        case IORING_OP_SEND:
+            return "send";
+        case IORING_OP_RECV:
+            return "recv";
+        case IORING_OP_SPLICE:
+            return "splice";
+        case IORING_OP_SHUTDOWN:
+            return "shutdown";
+        case IORING_OP_MSG_RING:
+            return "msg_ring";
+        case IORING_OP_SOCKET:
+            return "socket";
+        case IORING_OP_SEND_ZC:
+            return "send_zc";
+        default:
+            return "other";
+    }
+}
+
+void latency_stats::dump(std::FILE *out) const {
+    std::fprintf(
+        out, "%3s %-12s %-9s %10s %9s %9s %9s %9s %9s\n", "op", "name",
+        "phase", "count", "mean(us)", "p50(us)", "p99(us)", "p999(us)",
+        "max(us)"
+    );
+    auto print = [out](uint8_t opcode, const char *phase,
+                       const latency_histogram &h) {
+        if (h.count() == 0) {
+            return;
+        }
+        std::fprintf(
+            out,
+            "%3u %-12s %-9s %10" PRIu64 " %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+            unsigned(opcode), op_name(opcode), phase, h.count(),
+            double(h.mean()) / 1e3, double(h.value_at(0.5)) / 1e3,
+            double(h.value_at(0.99)) / 1e3, double(h.value_at(0.999)) / 1e3,
+            double(h.max()) / 1e3
+        );
+    };
+    for (uint32_t i = 0; i < op_num; ++i) {
+        if (const op_latency *op = ops[i].get()) {
+            print(uint8_t(i), "in_flight", op->in_flight);
+            print(uint8_t(i), "in_queue", op->in_queue);
+        }
+    }
+}
+
+} // namespace co_context::detail
@@ -0,0 +1,72 @@
+#include <co_context/detail/multishot.hpp>
+#include <co_context/detail/thread_meta.hpp>
+#include <co_context/detail/worker_meta.hpp>
+
+#include <cassert>
+#include <cerrno>
+#include <utility>
+
+namespace co_context::detail {
+
+void multishot_state::arm() noexcept {
+    liburingcxx::sq_entry *const sqe = owner->get_free_sqe();
+    prepare(*sqe);
+    sqe->set_data(as_user_data());
+    armed = true;
+}
+
+void multishot_state::abandon() noexcept {
+    assert(is_on_owner() && "a stream dropped out of its io_context");
+    for (const multishot_cqe &cqe : cqes) {
+        discard(cqe);
+    }
+    cqes.clear();
+    if (!armed) {
+        delete this;
+        return;
+    }
+
+    is_abandoned = true;
+    liburingcxx::sq_entry *const sqe = owner->get_free_sqe();
+    // Not skipped: a failed cancel (e.g. -ENOENT) posts its cqe anyway.
+    sqe->prep_cancle(as_user_data(), 0);
+    sqe->set_data(uint64_t(reserved_user_data::nop));
+}
+
+void multishot_state::on_cqe(int32_t res, uint32_t flags) noexcept {
+    if ((flags & IORING_CQE_F_MORE) == 0) {
+        armed = false;
+    }
+
+    if (is_abandoned) [[unlikely]] {
+        discard({res, flags});
+        if (!armed) {
+            delete this;
+        }
+        return;
+    }
+
+    if (!armed) {
+        if (res == -ENOBUFS && (!waiter || !cqes.empty())) {
+            // Out of buffers, not an error of the stream. Armed again by the
+            // next await, once the queued buffers are taken.
+            return;
+        }
+        if (res == -ENOBUFS && wait_for_buffer()) {
+            return;
+        }
+        if (is_final(res)) {
+            is_finished = true;
+            final_res = res;
+        }
+    }
+
+    cqes.push_back({res, flags});
+    if (waiter) {
+        owner->forward_task(
+            std::exchange(waiter, nullptr), waiter_prio
+        );
+    }
+}
+
+} // namespace co_context::detail
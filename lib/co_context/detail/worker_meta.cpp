@@ -2,23 +2,33 @@
 #include <co_context/co/semaphore.hpp>
 #include <co_context/config/io_context.hpp>
 #include <co_context/detail/compat.hpp>
+#include <co_context/detail/multishot.hpp>
 #include <co_context/detail/task_info.hpp>
 #include <co_context/detail/thread_meta.hpp>
 #include <co_context/detail/user_data.hpp>
 #include <co_context/io_context.hpp>
 #include <co_context/log/log.hpp>
 #include <co_context/utility/as_buffer.hpp>
+#include <co_context/zero_copy.hpp>
 #include <uring/cq_entry.hpp>
 #include <uring/uring_define.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cerrno>
+#include <chrono>
 #include <coroutine>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <exception>
+#include <iterator>
+#include <mutex>
+#include <system_error>
 #include <unistd.h>
 
 #if CO_CONTEXT_IS_USING_EVENTFD
-#include <mutex>
 #include <sys/eventfd.h>
 #endif
 
@@ -42,29 +52,228 @@ worker_meta::~worker_meta() noexcept {
 }
 #endif
 
-void worker_meta::init(unsigned io_uring_entries) {
+void worker_meta::init(
+    unsigned io_uring_entries, const io_context_options &options
+) {
     this->ctx_id = this_thread.ctx_id;
+    this->generation = io_context_meta.generation_count.fetch_add(
+        1, std::memory_order_relaxed
+    );
     this_thread.worker = this;
+    this->max_spin_ns = options.max_spin_ns;
+    this->submit_batch_max = options.submit_batch_max;
+    this->submit_budget_ns = options.submit_budget_ns;
+    this->send_zc_min_bytes = options.send_zc_min_bytes;
+    if (submit_budget_ns != 0) {
+        // Guess 1us per coroutine until learned.
+        this->resume_cost_ns = 1000;
+        this->resumes_per_submit =
+            std::max<uint32_t>(submit_budget_ns / 1000, 1);
+    }
+    this->frames = &frame_pool::local();
+#if CO_CONTEXT_USE_TRACE
+    this_thread.tracer = &tracer;
+    register_trace_buffer(tracer);
+#endif
 
-    ring.init(io_uring_entries);
+    init_ring(io_uring_entries, options);
+    probe_features();
 
 #if CO_CONTEXT_IS_USING_MSG_RING
     this->ring_fd = ring.fd();
 #endif
 
-    if (!check_init(io_uring_entries)) {
+    if (!check_init(io_uring_entries, options) || !check_features()) {
         std::terminate();
     }
 
+    fixed_buffers.init(
+        ring, options.fixed_buffer_num, options.fixed_buffer_size,
+        options.fixed_buffer_huge_pages
+    );
+
+    if (options.fixed_file_num != 0) {
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
+        const int res = ring.register_files_sparse(options.fixed_file_num);
+        if (res == 0) [[likely]] {
+            fixed_file_num = options.fixed_file_num;
+        } else {
+            log::w(
+                "io_context[%u] no file table: %s\n",
+                detail::this_thread.ctx_id, strerror(-res)
+            );
+        }
+#else
+        log::w(
+            "io_context[%u] no file table: linux 5.19 is needed\n",
+            detail::this_thread.ctx_id
+        );
+#endif
+    }
+
     log::i("io_context[%u] init a worker\n", detail::this_thread.ctx_id);
 }
 
+void worker_meta::init_ring(
+    unsigned io_uring_entries, const io_context_options &options
+) {
+    // Flags that may be dropped, from the least important one.
+    constexpr unsigned droppable_flags[] = {
+        IORING_SETUP_DEFER_TASKRUN,
+        IORING_SETUP_SINGLE_ISSUER,
+        IORING_SETUP_COOP_TASKRUN | IORING_SETUP_TASKRUN_FLAG,
+        IORING_SETUP_SQ_AFF,
+        IORING_SETUP_SQPOLL | IORING_SETUP_SQ_AFF,
+    };
+
+    unsigned flags = options.uring_setup_flags();
+    for (const unsigned *drop = std::begin(droppable_flags);;) {
+        uring::params params{flags};
+        params.sq_thread_idle = options.sq_thread_idle;
+        if (options.sq_thread_cpu >= 0) {
+            params.sq_thread_cpu = unsigned(options.sq_thread_cpu);
+        }
+
+        try {
+            ring.init(io_uring_entries, params);
+            break;
+        } catch (const std::system_error &e) {
+            const int err = e.code().value();
+            while (drop != std::end(droppable_flags)
+                   && ((flags & *drop & ~config::io_uring_setup_flags) == 0)) {
+                ++drop;
+            }
+            if ((err != EINVAL && err != EPERM)
+                || drop == std::end(droppable_flags)) {
+                throw;
+            }
+            log::w(
+                "worker[%u] io_uring_setup failed with flags=%x: %s. "
+                "Retry without %x\n",
+                ctx_id, flags, strerror(err), *drop
+            );
+            flags &= ~(*drop & ~config::io_uring_setup_flags);
+        }
+    }
+
+    log::i("worker[%u] io_uring setup flags=%x\n", ctx_id, ring.setup_flags());
+}
+
 void worker_meta::deinit() noexcept {
-    (void)this;
+#if CO_CONTEXT_USE_TRACE
+    unregister_trace_buffer(tracer);
+    this_thread.tracer = nullptr;
+#endif
     this_thread.worker = nullptr;
 }
 
-bool worker_meta::check_init(unsigned expect_sqring_size) const noexcept {
+void worker_meta::start_running() noexcept {
+    std::lock_guard lg{pending_mtx};
+    is_running.store(true, std::memory_order_release);
+    for (const auto &[handle, prio] : pending_spawns) {
+        co_spawn_unsafe(handle, is_work_stealing ? prio : lane_of(prio));
+    }
+    pending_spawns.clear();
+    pending_spawns.shrink_to_fit();
+}
+
+void worker_meta::stop_running() noexcept {
+    std::lock_guard lg{pending_mtx};
+    is_running.store(false, std::memory_order_relaxed);
+    is_stopped = true;
+}
+
+namespace {
+
+    void discard_spawn(
+        config::ctx_id_t ctx_id, std::coroutine_handle<> handle
+    ) noexcept {
+        log::w(
+            "worker[%u] has stopped, and destroys coro(%lx) spawned to it\n",
+            ctx_id, handle.address()
+        );
+        handle.destroy();
+    }
+
+} // namespace
+
+void worker_meta::discard_late_spawns() noexcept {
+    const auto discard = [this](std::coroutine_handle<> handle, priority) {
+        discard_spawn(ctx_id, handle);
+    };
+#if CO_CONTEXT_IS_USING_MSG_RING
+    // Nothing else is reaped once stopped.
+    defer_cq_entries();
+    for (const deferred_cqe &cqe : deferred_cqes) {
+        const uint64_t user_data = cqe.user_data;
+        if (user_data < uint64_t(reserved_user_data::none)) {
+            continue;
+        }
+        const uint64_t address = user_data & raw_task_info_mask;
+        switch (user_data_type(uint8_t(user_data & 0b111))) {
+            case user_data_type::msg_ring:
+                discard(
+                    std::coroutine_handle<>::from_address(
+                        reinterpret_cast<void *>(address) /*NOLINT*/
+                    ),
+                    priority::normal
+                );
+                break;
+            case user_data_type::msg_ring_batch:
+                reinterpret_cast<msg_ring_channel *>(address /*NOLINT*/)
+                    ->drain(discard);
+                break;
+            default:
+                break;
+        }
+    }
+    deferred_cqes.clear();
+#else
+    spawn_item item;
+    while (co_spawn_queue.try_pop(item)) {
+        discard(item.first, item.second);
+    }
+    std::lock_guard lg{co_spawn_mtx};
+    while (!co_spawn_overflow.empty()) {
+        discard(co_spawn_overflow.front().first, priority::normal);
+        co_spawn_overflow.pop();
+    }
+#endif
+}
+
+bool worker_meta::try_spawn_pending(
+    std::coroutine_handle<> handle, priority prio
+) noexcept {
+    std::lock_guard lg{pending_mtx};
+    // Recheck, since start_running() may have run.
+    if (is_running.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    if (is_stopped) [[unlikely]] {
+        discard_spawn(ctx_id, handle);
+        return true;
+    }
+    log::v(
+        "coro(%lx) is pending for worker[%u]\n", handle.address(), ctx_id
+    );
+    pending_spawns.emplace_back(handle, prio);
+    return true;
+}
+
+bool worker_meta::check_init(
+    unsigned expect_sqring_size, const io_context_options &options
+) const noexcept {
+    // A round of sharing must fit in the normal lane.
+    if (is_work_stealing
+        && options.swap_capacity / 2 < config::work_stealing_batch) {
+        log::e(
+            "worker_meta::init_check: "
+            "swap_capacity=%u is less than twice work_stealing_batch=%u\n",
+            options.swap_capacity, config::work_stealing_batch
+        );
+        return false;
+    }
+
     const unsigned actual_sqring_size = ring.get_sq_ring_entries();
 
     if (actual_sqring_size < expect_sqring_size) {
@@ -88,16 +297,132 @@ bool worker_meta::check_init(unsigned expect_sqring_size) const noexcept {
     return true;
 }
 
+void worker_meta::probe_features() noexcept {
+    features.feature_bits = ring.feature_bits();
+    features.setup_flags = ring.setup_flags();
+
+    constexpr unsigned nr_ops = 256;
+    constexpr size_t probe_size =
+        sizeof(io_uring_probe) + nr_ops * sizeof(io_uring_probe_op);
+    alignas(io_uring_probe) std::byte buf[probe_size]{};
+    auto *const probe = reinterpret_cast<io_uring_probe *>(buf);
+    const int res = ring.register_probe(probe, nr_ops);
+    if (res != 0) [[unlikely]] {
+        log::w(
+            "io_context[%u] no probe of opcodes: %s\n", ctx_id, strerror(-res)
+        );
+        return;
+    }
+    for (unsigned i = 0; i < probe->ops_len && i < nr_ops; ++i) {
+        if (probe->ops[i].flags & IO_URING_OP_SUPPORTED) {
+            features.ops.set(probe->ops[i].op);
+        }
+    }
+    log::i(
+        "io_context[%u] kernel supports %zu opcodes, features = %#x\n",
+        ctx_id, features.ops.count(), features.feature_bits
+    );
+}
+
+bool worker_meta::check_features() const noexcept {
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 17)
+    // The kernel at build time is newer than the running one, so that some
+    // paths taken without checks would fail.
+    const auto require = [this](bool is_supported, const char *what) {
+        if (!is_supported) [[unlikely]] {
+            log::e(
+                "io_context[%u] the kernel lacks %s, which is needed since "
+                "co_context is built for linux %d.%d\n",
+                ctx_id, what, LIBURINGCXX_KERNEL_VERSION_MAJOR,
+                LIBURINGCXX_KERNEL_VERSION_MINOR
+            );
+        }
+        return is_supported;
+    };
+
+    bool is_ok = require(features.has_cqe_skip(), "IORING_FEAT_CQE_SKIP");
+#if CO_CONTEXT_IS_USING_MSG_RING
+    is_ok &= require(features.has_msg_ring(), "IORING_OP_MSG_RING");
+#endif
+    return is_ok;
+#else
+    return true;
+#endif
+}
+
 liburingcxx::sq_entry *worker_meta::get_free_sqe() noexcept {
     log::v("worker[%u] get_free_sqe\n", this_thread.ctx_id);
     ++requests_to_reap; // NOTE may required no reap or required multi-reap.
-    ++requests_to_submit;
 
     auto *sqe = this->ring.get_sq_entry();
-    assert(sqe != nullptr);
+    if (sqe == nullptr) [[unlikely]] {
+        sqe = submit_on_full_sq();
+    }
+    ++requests_to_submit;
     return sqe;
 }
 
+liburingcxx::sq_entry *worker_meta::submit_on_full_sq() noexcept {
+    // The latest sqe is held back, since operator&& or link_chain may link
+    // it to the one being acquired. So is the link it ends, since the kernel
+    // cuts a link at the end of a submission.
+    const unsigned held = ring.linked_before_latest() + 1;
+    if (held >= ring.get_sq_ring_entries()) [[unlikely]] {
+        log::e(
+            "worker[%u] a link of %u sqes outgrows the sq ring\n", ctx_id,
+            held
+        );
+        std::terminate();
+    }
+    metrics_counters::add(metrics.sq_full_submits, 1);
+    for (;;) {
+        const int res = ring.submit_all_but(held);
+        record_submission(res);
+        requests_to_submit = held;
+
+        auto *const sqe = ring.get_sq_entry();
+        if (sqe != nullptr) [[likely]] {
+            return sqe;
+        }
+        if (res > 0) {
+            continue;
+        }
+        if (ring.setup_flags() & IORING_SETUP_SQPOLL) {
+            // The sq thread consumes the sqes later.
+            ring.wait_sq_ring();
+            continue;
+        }
+        if (res == 0 || res == -EBUSY || res == -EAGAIN || res == -EINTR) {
+            // The cq overflows, or the kernel is short of memory. Make room
+            // by reaping, without handling the cqes, since a handler may take
+            // an sqe in the middle of the link being built.
+            if (defer_cq_entries() == 0) {
+                wait_uring();
+                defer_cq_entries();
+            }
+            continue;
+        }
+        log::e(
+            "worker[%u] the sq ring is full, and submit fails: %d\n", ctx_id,
+            res
+        );
+        std::terminate();
+    }
+}
+
+uint32_t worker_meta::defer_cq_entries() noexcept {
+    using cq_entry = liburingcxx::cq_entry;
+    const uint32_t num =
+        ring.for_each_cqe([this](const cq_entry *cqe) noexcept {
+            deferred_cqes.push_back({cqe->user_data, cqe->res, cqe->flags});
+        });
+    if (num != 0) {
+        ring.cq_advance(num);
+        log::d("worker[%u] defers %u cqes\n", ctx_id, num);
+    }
+    return num;
+}
+
 #if CO_CONTEXT_IS_USING_EVENTFD
 void worker_meta::listen_on_co_spawn() noexcept {
     auto *const sqe = get_free_sqe();
@@ -106,71 +431,405 @@ void worker_meta::listen_on_co_spawn() noexcept {
 }
 #endif
 
-std::coroutine_handle<> worker_meta::schedule() noexcept {
-    auto &cur = this->reap_cur;
+void worker_meta::timed_wait_uring() noexcept {
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    wait_uring();
+    record_wait(start);
+}
 
-    log::v("worker[%u] try scheduling\n", this->ctx_id);
-    assert(!cur.is_empty());
+void worker_meta::spin_or_wait_uring() noexcept {
+    if (max_spin_ns == 0) [[likely]] {
+        timed_wait_uring();
+        return;
+    }
+
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    const uint32_t budget = spin_budget_ns();
+    if (budget != 0) {
+        const auto deadline = start + std::chrono::nanoseconds{budget};
+        do {
+            if (peek_uring()) {
+                ++spin_counters.hit_count;
+                learn_idle_gap((clock::now() - start).count());
+                return;
+            }
+            CO_CONTEXT_PAUSE();
+        } while (clock::now() < deadline);
+        ++spin_counters.miss_count;
+    }
 
-    std::coroutine_handle<> chosen_coro = reap_swap[cur.head()];
-    cur.pop();
-    assert(bool(chosen_coro));
-    return chosen_coro;
+    timed_wait_uring();
+    learn_idle_gap((clock::now() - start).count());
+}
+
+std::coroutine_handle<> worker_meta::schedule() noexcept {
+    log::v("worker[%u] try scheduling\n", this->ctx_id);
+    assert(has_task_ready());
+
+    for (;;) {
+        for (uint8_t i = 0; i < priority_num; ++i) {
+            if (lane_credits[i] != 0 && !reap_swap[i].empty()) {
+                --lane_credits[i];
+                std::coroutine_handle<> chosen_coro = reap_swap[i].pop();
+                assert(bool(chosen_coro));
+                if (is_pinned(chosen_coro)) {
+                    current_priority = with_pin(priority(i));
+                    return unpinned(chosen_coro);
+                }
+                current_priority = priority(i);
+                return chosen_coro;
+            }
+        }
+        // No ready lane has weight left. Begin a new round.
+        lane_credits = config::priority_weights;
+    }
 }
 
 void worker_meta::work_once() {
     const auto coro = this->schedule();
     log::v("worker[%u] resume %lx\n", this->ctx_id, coro.address());
+    trace(trace_event::resume, coro);
     coro.resume();
+    trace(trace_event::yield, coro);
+    current_priority = priority::normal;
 
     log::v("worker[%u] work_once finished\n", this->ctx_id);
 }
 
-void worker_meta::check_submission_threshold() noexcept {
-    if constexpr (config::submission_threshold != -1U) {
-        if (requests_to_submit >= config::submission_threshold) {
-            [[maybe_unused]] int res = ring.submit_and_get_events();
-            assert(res >= 0 && "exception at uring::submit");
-            requests_to_submit = 0;
+void worker_meta::work_bounded(uint32_t num) {
+    using clock = std::chrono::steady_clock;
+    const bool is_timed = submit_budget_ns != 0;
+    const auto start = is_timed ? clock::now() : clock::time_point{};
+    const uint32_t resumed = num;
+
+    for (uint32_t until_submit = resumes_per_submit; num > 0; --num) {
+        work_once();
+        if (requests_to_submit >= submit_batch_max || --until_submit == 0) {
+            until_submit = resumes_per_submit;
+            if (requests_to_submit != 0) {
+                submit_in_round();
+            }
         }
     }
+
+    if (is_timed) {
+        learn_resume_cost((clock::now() - start).count(), resumed);
+    }
+}
+
+void worker_meta::submit_in_round() noexcept {
+    [[maybe_unused]] int res = ring.submit_and_get_events();
+    assert(res >= 0 && "exception at uring::submit");
+    record_submission(res);
+    metrics_counters::add(metrics.round_submits, 1);
+    requests_to_submit = 0;
 }
 
-void worker_meta::poll_submission() noexcept {
+void worker_meta::record_wait(std::chrono::steady_clock::time_point start
+) noexcept {
+    const auto blocked = std::chrono::steady_clock::now() - start;
+    metrics_counters::add(metrics.wait_count, 1);
+    metrics_counters::add(metrics.wait_ns, uint64_t(blocked.count()));
+}
+
+void worker_meta::record_submission(int submitted) noexcept {
+    metrics_counters::add(metrics.submit_syscalls, 1);
+    if (submitted > 0) {
+        metrics_counters::add(metrics.sqe_submitted, uint64_t(submitted));
+    }
+    // Both are cheap loads from the shared ring.
+    metrics.sq_dropped.store(ring.sq_dropped(), std::memory_order_relaxed);
+    metrics.cq_overflow.store(ring.cq_overflow(), std::memory_order_relaxed);
+}
+
+void worker_meta::poll_submission(bool may_wait) noexcept {
     // submit sqes
     if (requests_to_submit) [[likely]] {
-        bool will_wait = !has_task_ready();
+        // In work-stealing or spinning mode, block in the bad path instead.
+        bool will_wait = may_wait && !has_task_ready() && !is_work_stealing
+                         && max_spin_ns == 0;
         log::v("worker_meta::poll_submission(): before submit_and_wait\n");
+        using clock = std::chrono::steady_clock;
+        const auto start = will_wait ? clock::now() : clock::time_point{};
         [[maybe_unused]] int res = ring.submit_and_wait(will_wait);
         assert(
             (res >= 0 || res == -EINTR) && "exception at uring::submit_and_wait"
         );
+        record_submission(res);
+        if (will_wait) {
+            record_wait(start);
+        }
         requests_to_submit = 0;
         log::v("worker_meta::poll_submission(): after submit_and_wait\n");
     }
 }
 
-void worker_meta::forward_task(std::coroutine_handle<> handle) noexcept {
+void worker_meta::forward_task(
+    std::coroutine_handle<> handle, priority prio
+) noexcept {
     assert(bool(handle) && "forwarding an empty task");
 
-    auto &cur = reap_cur;
     log::v(
-        "worker[%u] forward_task(%lx) to [%u]\n", ctx_id, handle.address(),
-        cur.tail()
+        "worker[%u] forward_task(%lx) to lane %u\n", ctx_id, handle.address(),
+        uint8_t(lane_of(prio))
     );
 
-    reap_swap[cur.tail()] = handle;
-    cur.push();
+    // A pinned coroutine is tagged, so that it will never be shared.
+    lane(prio).push(has_pin(prio) ? as_pinned(handle) : handle);
 }
 
+void worker_meta::forward_pinned_task(
+    std::coroutine_handle<> handle, priority prio
+) noexcept {
+    trace(trace_event::hop_in, handle);
+    forward_task(handle, is_work_stealing ? with_pin(prio) : prio);
+}
+
+void worker_meta::register_steal_peer() noexcept {
+    auto &meta = io_context_meta;
+    std::lock_guard lg{meta.mtx};
+    if (meta.steal_peers == nullptr) {
+        // Published to thieves by the release store of steal_peer_num.
+        meta.steal_peers =
+            std::make_unique<std::atomic<worker_meta *>[]>(ctx_id_space);
+    }
+    const uint32_t num = meta.steal_peer_num.load(std::memory_order_relaxed);
+    // Reuse a slot left by a stopped peer, so that the list does not grow
+    // with the churn of io_contexts.
+    uint32_t idx = 0;
+    while (idx < num
+           && meta.steal_peers[idx].load(std::memory_order_relaxed)
+                  != nullptr) {
+        ++idx;
+    }
+    meta.steal_peers[idx].store(this, std::memory_order_release);
+    if (idx == num) {
+        meta.steal_peer_num.store(num + 1, std::memory_order_release);
+    }
+    log::d("worker[%u] joins the work-stealing peers\n", ctx_id);
+}
+
+void worker_meta::unregister_steal_peer() noexcept {
+    auto &meta = io_context_meta;
+    std::lock_guard lg{meta.mtx};
+    uint32_t num = meta.steal_peer_num.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < num; ++i) {
+        if (meta.steal_peers[i].load(std::memory_order_relaxed) == this) {
+            meta.steal_peers[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+    while (num > 0
+           && meta.steal_peers[num - 1].load(std::memory_order_relaxed)
+                  == nullptr) {
+        --num;
+    }
+    meta.steal_peer_num.store(num, std::memory_order_release);
+}
+
+void worker_meta::rebalance() {
+    using config::work_stealing_batch;
+    using config::work_stealing_threshold;
+
+    // 1. Take back the unclaimed coroutines, so that none of them starves.
+    if (shared_ready.size_hint() != 0) {
+        shared_ready.pop_bulk(
+            shared_ready.size_hint(),
+            [this](std::coroutine_handle<> handle) {
+                forward_task(handle, priority::normal);
+            }
+        );
+    }
+
+    // 2. Share the oldest surplus of the normal lane. The pinned coroutines
+    // go back to the lane, and are resumed in this round still.
+    ready_queue &normal_lane = lane(priority::normal);
+    const auto ready_num = cur_t(normal_lane.size());
+    if (ready_num > work_stealing_threshold) {
+        const cur_t share_num = std::min<cur_t>(
+            work_stealing_batch, (ready_num - work_stealing_threshold + 1) / 2
+        );
+        std::array<std::coroutine_handle<>, work_stealing_batch> surplus;
+        cur_t surplus_num = 0;
+        for (cur_t i = 0; i < share_num; ++i) {
+            const std::coroutine_handle<> handle = normal_lane.pop();
+            if (is_pinned(handle)) {
+                normal_lane.push(handle);
+            } else {
+                surplus[surplus_num++] = handle;
+            }
+        }
+        if (surplus_num != 0) {
+            shared_ready.push_bulk(
+                surplus.begin(), surplus.begin() + surplus_num
+            );
+            log::v("worker[%u] shares %u coroutines\n", ctx_id, surplus_num);
+            wake_up_a_thief();
+        }
+    }
+}
+
+bool worker_meta::try_steal() noexcept {
+    const auto forward = [this](std::coroutine_handle<> handle) {
+        forward_task(handle, priority::normal);
+    };
+
+    // Take back the coroutines shared by myself first.
+    if (shared_ready.size_hint() != 0
+        && shared_ready.pop_bulk(config::work_stealing_batch, forward) != 0) {
+        return true;
+    }
+
+    const auto &meta = io_context_meta;
+    const uint32_t num = meta.steal_peer_num.load(std::memory_order_acquire);
+    const cur_t max_num = config::work_stealing_batch;
+
+    // Choose the most loaded peer.
+    worker_meta *victim = nullptr;
+    cur_t victim_load = 0;
+    for (uint32_t i = 0; i < num; ++i) {
+        worker_meta *peer = meta.steal_peers[i].load(std::memory_order_acquire);
+        if (peer == nullptr || peer == this) {
+            continue;
+        }
+        const cur_t load = peer->shared_ready.size_hint();
+        if (load > victim_load) {
+            victim = peer;
+            victim_load = load;
+        }
+    }
+
+    if (victim == nullptr) {
+        return false;
+    }
+
+    const cur_t stolen = victim->shared_ready.steal_half(max_num, forward);
+    log::v(
+        "worker[%u] steals %u coroutines from worker[%u]\n", ctx_id, stolen,
+        victim->ctx_id
+    );
+    return stolen != 0;
+}
+
+bool worker_meta::park() noexcept {
+    // Pairs with the seq_cst exchange in wake_up_a_thief(): either the sharer
+    // sees `is_parked`, or this thief sees the shared coroutines.
+    is_parked.store(true, std::memory_order_seq_cst);
+    if (try_steal()) {
+        unpark();
+        return false;
+    }
+    return true;
+}
+
+void worker_meta::wake_up_a_thief() noexcept {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const auto &meta = io_context_meta;
+    const uint32_t num = meta.steal_peer_num.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < num; ++i) {
+        worker_meta *peer = meta.steal_peers[i].load(std::memory_order_acquire);
+        if (peer == nullptr || peer == this
+            || !peer->is_parked.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        if (peer->is_parked.exchange(false, std::memory_order_seq_cst)) {
+            peer->wake_up();
+            return;
+        }
+    }
+}
+
+void worker_meta::wake_up() noexcept {
+    log::v("worker[%u] is woken up\n", ctx_id);
+#if CO_CONTEXT_IS_USING_MSG_RING
+    worker_meta &from = *this_thread.worker;
+    auto *const sqe = from.get_free_sqe();
+    sqe->prep_msg_ring(
+        ring_fd, 0, static_cast<uint64_t>(reserved_user_data::wakeup), 0
+    );
+    sqe->set_data(uint64_t(reserved_user_data::msg_ring_failed));
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 17)
+    sqe->set_cqe_skip();
+    --from.requests_to_reap;
+#endif
+#else
+    notify_co_spawn();
+#endif
+}
+
+#if CO_CONTEXT_IS_USING_MSG_RING
+void worker_meta::notify_outbox() noexcept {
+    for (msg_ring_channel *const channel : dirty_outbox) {
+        channel->is_dirty = false;
+        if (!channel->mark_notified()) {
+            continue;
+        }
+        auto *const sqe = get_free_sqe();
+        auto user_data = reinterpret_cast<uint64_t>(channel)
+                         | uint8_t(user_data_type::msg_ring_batch);
+        sqe->prep_msg_ring(channel->target_ring_fd, 0, user_data, 0);
+        sqe->set_data(uint64_t(reserved_user_data::msg_ring_failed));
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 17)
+        sqe->set_cqe_skip();
+        --requests_to_reap;
+#endif
+    }
+    dirty_outbox.clear();
+}
+
+msg_ring_channel &worker_meta::new_channel_to(worker_meta &target) {
+    if (outbox.size() <= target.ctx_id) {
+        outbox.resize(size_t(target.ctx_id) + 1);
+    }
+    outbox_entry &entry = outbox[target.ctx_id];
+    if (entry.channel != nullptr) {
+        // The old receiver has stopped. Never touch its channel again.
+        std::erase(dirty_outbox, entry.channel);
+    }
+    entry.channel = &target.inbox_from(*this);
+    entry.generation = target.generation;
+    return *entry.channel;
+}
+
+msg_ring_channel &worker_meta::grow_channel_to(worker_meta &target) {
+    outbox_entry &entry = outbox[target.ctx_id];
+    // The old channel stays dirty if so, and is notified as usual.
+    entry.channel = &target.inbox_from(*this, entry.channel->capacity() * 4);
+    return *entry.channel;
+}
+
+msg_ring_channel &
+worker_meta::inbox_from(const worker_meta &sender, cur_t min_capacity) {
+    std::lock_guard lg{inbox_mtx};
+    if (inbox.size() <= sender.ctx_id) {
+        inbox.resize(size_t(sender.ctx_id) + 1);
+    }
+    auto &channel = inbox[sender.ctx_id];
+    if (channel != nullptr && channel->capacity() < min_capacity) {
+        outgrown_inbox.push_back(std::move(channel));
+    }
+    if (channel == nullptr) {
+        channel = std::make_unique<msg_ring_channel>(ring_fd, min_capacity);
+    }
+    return *channel;
+}
+#endif
+
 void worker_meta::handle_cq_entry(const liburingcxx::cq_entry *const cqe
 ) noexcept {
+    const deferred_cqe copy{cqe->user_data, cqe->res, cqe->flags};
+    ring.seen_cq_entry(cqe);
+    handle_cq_entry(copy);
+}
+
+void worker_meta::handle_cq_entry(const deferred_cqe &cqe) noexcept {
     --requests_to_reap;
     log::v("ctx poll_completion found, remaining=%d\n", requests_to_reap);
 
-    uint64_t user_data = cqe->user_data;
-    const int32_t result = cqe->res;
-    [[maybe_unused]] const uint32_t flags = cqe->flags;
+    uint64_t user_data = cqe.user_data;
+    const int32_t result = cqe.res;
+    const uint32_t flags = cqe.flags;
 
     if (config::is_log_d && result < 0) {
         log::d(
@@ -180,8 +839,6 @@ void worker_meta::handle_cq_entry(const liburingcxx::cq_entry *const cqe
         );
     }
 
-    ring.seen_cq_entry(cqe);
-
     if constexpr (uint64_t(detail::reserved_user_data::none) > 0) {
         if (user_data < uint64_t(detail::reserved_user_data::none))
             [[unlikely]] {
@@ -200,28 +857,88 @@ void worker_meta::handle_cq_entry(const liburingcxx::cq_entry *const cqe
             reinterpret_cast /*NOLINT*/<task_info *>(user_data)
         );
 
+#if CO_CONTEXT_USE_LATENCY_HISTOGRAM
+    if ((selector == mux::task_info_ptr
+         || selector == mux::task_info_ptr__link_sqe)
+        && (flags & IORING_CQE_F_NOTIF) == 0) {
+        io_info->complete_ns = latency_clock_ns();
+        latency.record_in_flight(
+            io_info->opcode, io_info->complete_ns - io_info->submit_ns
+        );
+    }
+#endif
+
     switch (selector) {
         [[likely]] case mux::task_info_ptr:
+            if (flags & (IORING_CQE_F_MORE | IORING_CQE_F_NOTIF))
+                [[unlikely]] {
+                // More cqes follow, e.g. the notification of a zero-copy send
+                // without a zc_notification, dropped since nobody awaits it.
+                if (flags & IORING_CQE_F_NOTIF) {
+                    break;
+                }
+                ++requests_to_reap;
+            }
             io_info->result = result;
-            // io_info->flags = flags;
-            forward_task(io_info->handle);
+            io_info->cqe_flags = uint8_t(flags);
+            io_info->buf_id = uint16_t(flags >> IORING_CQE_BUFFER_SHIFT);
+            trace(trace_event::complete, io_info->handle, uint32_t(result));
+            forward_task(io_info->handle, io_info->prio);
             break;
         case mux::coroutine_handle:
-            forward_task(std::coroutine_handle<>::from_address(
-                reinterpret_cast<void *>(user_data) /*NOLINT*/
-            ));
+            forward_task(
+                std::coroutine_handle<>::from_address(
+                    reinterpret_cast<void *>(user_data) /*NOLINT*/
+                ),
+                priority::normal
+            );
             break;
         case mux::task_info_ptr__link_sqe:
             // transfer the result of io, but do not resume the task
             io_info->result = result;
-            // io_info->flags = flags;
+            io_info->cqe_flags = uint8_t(flags);
+            io_info->buf_id = uint16_t(flags >> IORING_CQE_BUFFER_SHIFT);
             break;
         case mux::msg_ring:
-            forward_task(std::coroutine_handle<>::from_address(
-                reinterpret_cast<void *>(user_data) /*NOLINT*/
-            ));
+            forward_pinned_task(
+                std::coroutine_handle<>::from_address(
+                    reinterpret_cast<void *>(user_data) /*NOLINT*/
+                ),
+                priority(result)
+            );
+            ++requests_to_reap;
+            break;
+#if CO_CONTEXT_IS_USING_MSG_RING
+        case mux::msg_ring_batch:
+            reinterpret_cast<msg_ring_channel *>(user_data /*NOLINT*/)
+                ->drain([this](std::coroutine_handle<> handle, priority prio) {
+                    forward_pinned_task(handle, prio);
+                });
             ++requests_to_reap;
             break;
+#else
+        [[unlikely]] case mux::msg_ring_batch:
+            assert(false && "handle_cq_entry(): no msg_ring_batch by eventfd");
+            break;
+#endif
+        case mux::multishot:
+            // The request stays armed, so one more cqe is expected.
+            if (flags & IORING_CQE_F_MORE) {
+                ++requests_to_reap;
+            }
+            reinterpret_cast<multishot_state *>(user_data /*NOLINT*/)
+                ->on_cqe(result, flags);
+            break;
+        case mux::zero_copy:
+#if LIBURINGCXX_IS_KERNEL_REACH(6, 0)
+            // The notification follows the result.
+            if (flags & IORING_CQE_F_MORE) {
+                ++requests_to_reap;
+            }
+            reinterpret_cast<zc_send_state *>(user_data /*NOLINT*/)
+                ->on_cqe(result, flags);
+#endif
+            break;
         [[unlikely]] case mux::none:
             assert(false && "handle_cq_entry(): unknown case");
     }
@@ -238,6 +955,18 @@ void worker_meta::handle_reserved_user_data(const uint64_t user_data) noexcept {
 #endif
         case mux::nop:
             break;
+        case mux::wakeup:
+            // sent by msg_ring, which is not counted by this worker
+            ++requests_to_reap;
+            break;
+        case mux::msg_ring_failed:
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 17)
+            // The cqe was skipped, so it is not counted. It only arrives if
+            // the target ring is gone, e.g. the io_context was destroyed.
+            ++requests_to_reap;
+            log::w("worker[%u] failed to msg_ring a stopped worker\n", ctx_id);
+#endif
+            break;
         [[unlikely]] case mux::none:
             break;
     }
@@ -247,39 +976,38 @@ void worker_meta::handle_reserved_user_data(const uint64_t user_data) noexcept {
 void worker_meta::handle_co_spawn_events() noexcept {
     assert(co_spawn_local_queue.empty());
 
-    {
-        std::lock_guard lg{co_spawn_mtx};
-        co_spawn_local_queue.swap(co_spawn_queue);
-    }
+    // Reset before draining, so that a producer pushing after the drain will
+    // write the eventfd again. The acquire pairs with notify_co_spawn().
+    is_co_spawn_notified.exchange(false, std::memory_order_acq_rel);
 
-    const size_t overflow_level = reap_cur.available_number();
-    size_t num = co_spawn_local_queue.size();
+    spawn_item item;
+    while (co_spawn_queue.try_pop(item)) {
+        forward_pinned_task(item.first, item.second);
+    }
 
-    if (overflow_level < num) [[unlikely]] {
-        log::e(
-            "Too many co_spawn() exhausted reap_swap "
-            "at worker[%u]: panding = %u, free_space = %u\n",
-            this->ctx_id, num, overflow_level
-        );
-        std::terminate();
+    if (has_co_spawn_overflow.load(std::memory_order_relaxed)) [[unlikely]] {
+        {
+            std::lock_guard lg{co_spawn_mtx};
+            co_spawn_local_queue.swap(co_spawn_overflow);
+            has_co_spawn_overflow.store(false, std::memory_order_relaxed);
+        }
+        while (!co_spawn_local_queue.empty()) {
+            const auto [handle, prio] = co_spawn_local_queue.front();
+            forward_pinned_task(handle, prio);
+            co_spawn_local_queue.pop();
+        }
     }
 
     if constexpr (config::is_log_w) {
-        const size_t warning_level = overflow_level / 4 * 3;
-        if (warning_level <= num) [[unlikely]] {
+        if (has_spilling_lane()) [[unlikely]] {
             log::w(
-                "Too many co_spawn(). worker[%u] is running out of "
-                "reap_swap: panding = %u, free_space = %u\n",
-                this->ctx_id, num, overflow_level
+                "Too many co_spawn(). worker[%u] spills the reap_swap: "
+                "pending = %u\n",
+                this->ctx_id, number_to_schedule()
             );
         }
     }
 
-    while (num--) {
-        forward_task(co_spawn_local_queue.front());
-        co_spawn_local_queue.pop();
-    }
-
     listen_on_co_spawn();
 }
 #endif
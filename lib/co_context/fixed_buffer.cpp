@@ -0,0 +1,100 @@
+#include <co_context/fixed_buffer.hpp>
+#include <co_context/log/log.hpp>
+
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+#include <cstring>
+
+namespace co_context {
+
+namespace {
+
+    constexpr size_t huge_page_size = size_t(2) << 20;
+
+    // IORING_MAX_REG_BUFFERS of the kernel
+    constexpr uint32_t max_buffer_num = 1U << 14;
+
+    char *map_arena(size_t size, bool use_huge_pages) noexcept {
+        constexpr int prot = PROT_READ | PROT_WRITE;
+        constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        if (use_huge_pages) {
+            void *const addr =
+                ::mmap(nullptr, size, prot, flags | MAP_HUGETLB, -1, 0);
+            if (addr != MAP_FAILED) [[likely]] {
+                return static_cast<char *>(addr);
+            }
+            log::w(
+                "fixed_buffer_pool: no huge page (%s). Use normal pages\n",
+                strerror(errno)
+            );
+        }
+        void *const addr = ::mmap(nullptr, size, prot, flags, -1, 0);
+        return addr != MAP_FAILED ? static_cast<char *>(addr) : nullptr;
+    }
+
+} // namespace
+
+void fixed_buffer_pool::init(
+    detail::uring &ring,
+    uint32_t buffer_num,
+    uint32_t buffer_size,
+    bool use_huge_pages
+) noexcept {
+    assert(arena == nullptr && "The pool may be inited twice.");
+    this->owner = detail::this_thread.worker;
+    if (buffer_num == 0 || buffer_size == 0) {
+        return;
+    }
+    if (buffer_num > max_buffer_num) [[unlikely]] {
+        log::w(
+            "fixed_buffer_pool: at most %u buffers. %u are asked\n",
+            max_buffer_num, buffer_num
+        );
+        buffer_num = max_buffer_num;
+    }
+
+    size_t size = size_t(buffer_num) * buffer_size;
+    if (use_huge_pages) {
+        size = (size + huge_page_size - 1) & ~(huge_page_size - 1);
+    }
+    char *const addr = map_arena(size, use_huge_pages);
+    if (addr == nullptr) [[unlikely]] {
+        log::w("fixed_buffer_pool: mmap failed: %s\n", strerror(errno));
+        return;
+    }
+
+    std::vector<iovec> iovecs(buffer_num);
+    for (uint32_t i = 0; i < buffer_num; ++i) {
+        iovecs[i].iov_base = addr + size_t(i) * buffer_size;
+        iovecs[i].iov_len = buffer_size;
+    }
+    const int res = ring.register_buffers(iovecs.data(), buffer_num);
+    if (res < 0) [[unlikely]] {
+        // e.g. ENOMEM if RLIMIT_MEMLOCK is too low before linux 5.12
+        log::w(
+            "fixed_buffer_pool: register_buffers failed: %s\n", strerror(-res)
+        );
+        ::munmap(addr, size);
+        return;
+    }
+
+    this->arena = addr;
+    this->arena_size = size;
+    this->buffer_num = buffer_num;
+    this->buffer_size = buffer_size;
+    free_indexes.resize(buffer_num);
+    for (uint32_t i = 0; i < buffer_num; ++i) {
+        // The lowest index is lent first.
+        free_indexes[i] = uint16_t(buffer_num - 1 - i);
+    }
+}
+
+fixed_buffer_pool::~fixed_buffer_pool() noexcept {
+    // The registration is dropped with the ring.
+    if (arena != nullptr) {
+        ::munmap(arena, arena_size);
+    }
+}
+
+} // namespace co_context
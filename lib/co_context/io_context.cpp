@@ -10,10 +10,12 @@
 #include <co_context/io_context.hpp>
 #include <co_context/log/log.hpp>
 
+#include <pthread.h>
 #include <unistd.h>
 
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <exception>
 #include <mutex>
 #include <thread>
@@ -25,7 +27,11 @@ void io_context::init() {
     detail::this_thread.ctx = this;
     detail::this_thread.ctx_id = this->id;
 
-    this->worker.init(config::default_io_uring_entries);
+    this->worker.init(this->options.uring_entries(), this->options);
+
+    if (this->worker.is_work_stealing) {
+        this->worker.register_steal_peer();
+    }
 }
 
 // Must be called by corresponding thread.
@@ -33,72 +39,123 @@ void io_context::deinit() noexcept {
     detail::this_thread.ctx = nullptr;
     detail::this_thread.ctx_id = static_cast<config::ctx_id_t>(-1);
 
+    if (this->worker.is_work_stealing) {
+        this->worker.unregister_steal_peer();
+    }
+
+    this->worker.stop_running();
+    this->worker.discard_late_spawns();
     this->worker.deinit();
 
     auto &meta = detail::io_context_meta;
-    std::lock_guard lg{meta.mtx};
-    --meta.ready_count;
-    --meta.create_count;
+    const uint32_t ready_count =
+        meta.ready_count.fetch_sub(1, std::memory_order_relaxed) - 1;
     log::d(
-        "io_context::deinit(): &meta.create_count = %lx  value = %u\n",
-        &meta.create_count, meta.create_count
+        "io_context[%u] deinit. %u io_contexts are running\n", this->id,
+        ready_count
     );
 }
 
+void io_context::apply_cpu_affinity() noexcept {
+    const int res = ::pthread_setaffinity_np(
+        ::pthread_self(), sizeof(cpu_set_t), &cpu_affinity
+    );
+    if (res != 0) [[unlikely]] {
+        log::w(
+            "io_context[%u] failed to set cpu affinity: %s\n", this->id,
+            strerror(res)
+        );
+    }
+}
+
 void io_context::start() {
-    host_thread = std::thread{[this] {
-        this->init();
-        auto &meta = detail::io_context_meta;
-        {
-            std::unique_lock lock{meta.mtx};
-            ++meta.ready_count;
-            log::d(
-                "io_context[%u] ready. (%u/%u)\n", this->id, meta.create_count,
-                meta.ready_count
-            );
-            if (!meta.cv.wait_for(lock, std::chrono::seconds{1}, [] {
-                    return meta.create_count == meta.ready_count;
-                })) {
-                log::e("io_context initialization timeout. There exists an "
-                       "io_context that has not been started.\n");
-                std::terminate();
-            }
+    // Counted before the thread runs, so that an idle io_context started
+    // earlier will not stop before this one is ready to take its spawns.
+    auto &meta = detail::io_context_meta;
+    const uint32_t ready_count =
+        meta.ready_count.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    host_thread = std::thread{[this, ready_count] {
+        if (this->has_cpu_affinity) {
+            this->apply_cpu_affinity();
         }
-        meta.cv.notify_all();
+        this->init();
+        log::d(
+            "io_context[%u] ready. %u io_contexts are running\n", this->id,
+            ready_count
+        );
 
-        // All io_context gets its uring ready from now.
+        // Other io_contexts may spawn onto this one from now, without
+        // waiting for the rest to start.
+        this->worker.start_running();
 
         this->run();
     }};
 }
 
 void io_context::do_worker_part() {
+    if (worker.is_work_stealing) [[unlikely]] {
+        worker.rebalance();
+    }
+
     auto num = worker.number_to_schedule();
     log::v("worker[%u] will run %u times...\n", id, num);
+    if (num > 0) {
+        using counters = detail::metrics_counters;
+        counters::add(worker.metrics.worker_rounds, 1);
+        counters::add(worker.metrics.coroutines_resumed, num);
+        counters::raise(worker.metrics.ready_high_water, num);
+    }
+    if (worker.is_submission_bounded()) [[unlikely]] {
+        worker.work_bounded(num);
+        return;
+    }
     for (; num > 0; --num) {
         worker.work_once();
-        if constexpr (config::submission_threshold != -1U) {
-            worker.check_submission_threshold();
-        }
     }
 }
 
 void io_context::do_submission_part() noexcept {
-    worker.poll_submission();
+#if CO_CONTEXT_IS_USING_MSG_RING
+    worker.flush_outbox();
+#endif
+    worker.poll_submission(!will_stop);
 }
 
+namespace {
+
+    bool has_other_running(const detail::io_context_meta_type &meta) noexcept {
+        return meta.ready_count.load(std::memory_order_relaxed) > 1;
+    }
+
+} // namespace
+
 void io_context::do_completion_part_bad_path() noexcept {
     log::v("do_completion_part_bad_path(): bad path\n");
+    if (will_stop) [[unlikely]] {
+        // can_stop() was called. Leave without waiting for the others.
+        return;
+    }
     const auto &meta = detail::io_context_meta;
+    const bool is_work_stealing = worker.is_work_stealing;
+    if (is_work_stealing && worker.try_steal()) {
+        return;
+    }
     if (!worker.peek_uring()
-        && (worker.requests_to_reap > 0 || meta.ready_count > 1)) {
+        && (worker.requests_to_reap > 0 || has_other_running(meta))) {
+        if (is_work_stealing && !worker.park()) {
+            return;
+        }
         log::v("do_completion_part_bad_path(): block on worker.wait_uring()\n");
-        worker.wait_uring();
+        worker.spin_or_wait_uring();
+        if (is_work_stealing) {
+            worker.unpark();
+        }
     }
     const uint32_t handled_num = worker.poll_completion();
 
     bool is_not_over =
-        handled_num | (meta.ready_count > 1) | worker.requests_to_reap;
+        handled_num | has_other_running(meta) | worker.requests_to_reap;
 
     if (!is_not_over) [[unlikely]] {
         will_stop = true;
@@ -127,10 +184,9 @@ void io_context::run() {
     );
 
 #if CO_CONTEXT_IS_USING_EVENTFD
-    auto &meta = detail::io_context_meta;
-    if (meta.create_count >= 2) {
-        worker.listen_on_co_spawn();
-    }
+    // Listen even if this is the only io_context, since another one may join
+    // at any time.
+    worker.listen_on_co_spawn();
 #endif
 
     while (!will_stop) [[likely]] {
@@ -0,0 +1,229 @@
+#include <co_context/io_context_pool.hpp>
+#include <co_context/log/log.hpp>
+#include <co_context/utility/defer.hpp>
+
+#include <sched.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <utility>
+
+namespace co_context {
+
+namespace {
+
+    // Parse a cpulist like "0-3,8,10-11".
+    std::vector<int> parse_cpu_list(const std::string &list) {
+        std::vector<int> cpus;
+        size_t pos = 0;
+        while (pos < list.size()) {
+            size_t end = list.find(',', pos);
+            if (end == std::string::npos) {
+                end = list.size();
+            }
+            int first = 0;
+            int last = 0;
+            const std::string range = list.substr(pos, end - pos);
+            const int n = std::sscanf(range.c_str(), "%d-%d", &first, &last);
+            if (n == 1) {
+                last = first;
+            }
+            if (n >= 1) {
+                for (int cpu = first; cpu <= last; ++cpu) {
+                    cpus.push_back(cpu);
+                }
+            }
+            pos = end + 1;
+        }
+        return cpus;
+    }
+
+    bool read_line(const std::string &path, std::string &line) {
+        std::ifstream file{path};
+        return bool(std::getline(file, line));
+    }
+
+    // CPUs that this process is allowed to run on.
+    std::vector<int> allowed_cpus() {
+        std::vector<int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (::sched_getaffinity(0, sizeof(set), &set) != 0) [[unlikely]] {
+            return cpus;
+        }
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    // The first allowed hyper-thread of each physical core.
+    std::vector<int> physical_cores(const std::vector<int> &allowed) {
+        std::vector<int> cores;
+        std::vector<std::pair<std::string, std::string>> seen;
+        for (const int cpu : allowed) {
+            const std::string dir = "/sys/devices/system/cpu/cpu"
+                                    + std::to_string(cpu) + "/topology/";
+            std::string package;
+            std::string core;
+            if (!read_line(dir + "physical_package_id", package)
+                || !read_line(dir + "core_id", core)) {
+                cores.push_back(cpu);
+                continue;
+            }
+            auto id = std::make_pair(std::move(package), std::move(core));
+            if (std::find(seen.begin(), seen.end(), id) == seen.end()) {
+                seen.push_back(std::move(id));
+                cores.push_back(cpu);
+            }
+        }
+        return cores;
+    }
+
+    // The allowed CPUs of each NUMA node. No NUMA means a single node.
+    std::vector<std::vector<int>> numa_nodes(const std::vector<int> &allowed) {
+        std::vector<std::vector<int>> nodes;
+        std::string line;
+        for (int node = 0;
+             read_line(
+                 "/sys/devices/system/node/node" + std::to_string(node)
+                     + "/cpulist",
+                 line
+             );
+             ++node) {
+            std::vector<int> cpus;
+            for (const int cpu : parse_cpu_list(line)) {
+                if (std::find(allowed.begin(), allowed.end(), cpu)
+                    != allowed.end()) {
+                    cpus.push_back(cpu);
+                }
+            }
+            if (!cpus.empty()) {
+                nodes.push_back(std::move(cpus));
+            }
+        }
+        if (nodes.empty()) {
+            nodes.push_back(allowed);
+        }
+        return nodes;
+    }
+
+    cpu_set_t to_cpu_set(const std::vector<int> &cpus) noexcept {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const int cpu : cpus) {
+            CPU_SET(cpu, &set);
+        }
+        return set;
+    }
+
+    // An empty pool has no io_context to spawn to.
+    size_t checked_size(size_t size) noexcept {
+        if (size == 0) [[unlikely]] {
+            log::e("io_context_pool: the size must not be 0\n");
+            std::terminate();
+        }
+        return size;
+    }
+
+} // namespace
+
+io_context_pool::io_context_pool(size_t size, placement how)
+    : ctx_num(checked_size(size))
+    , contexts(std::make_unique<io_context[]>(size))
+    , loads(std::make_unique<load_counter[]>(size)) {
+    place(how);
+}
+
+io_context_pool::io_context_pool(const std::vector<int> &cpus)
+    : ctx_num(checked_size(cpus.size()))
+    , contexts(std::make_unique<io_context[]>(cpus.size()))
+    , loads(std::make_unique<load_counter[]>(cpus.size())) {
+    for (size_t i = 0; i < ctx_num; ++i) {
+        contexts[i].set_cpu_affinity(cpus[i]);
+    }
+}
+
+void io_context_pool::place(placement how) {
+    if (how == placement::none) {
+        return;
+    }
+
+    const std::vector<int> allowed = allowed_cpus();
+    if (allowed.empty()) [[unlikely]] {
+        log::w("io_context_pool: failed to get the cpu affinity\n");
+        return;
+    }
+
+    switch (how) {
+        case placement::per_cpu:
+            for (size_t i = 0; i < ctx_num; ++i) {
+                contexts[i].set_cpu_affinity(allowed[i % allowed.size()]);
+            }
+            break;
+        case placement::per_physical_core: {
+            const std::vector<int> cores = physical_cores(allowed);
+            for (size_t i = 0; i < ctx_num; ++i) {
+                contexts[i].set_cpu_affinity(cores[i % cores.size()]);
+            }
+            break;
+        }
+        case placement::per_numa_node: {
+            const auto nodes = numa_nodes(allowed);
+            for (size_t i = 0; i < ctx_num; ++i) {
+                contexts[i].set_cpu_affinity(
+                    to_cpu_set(nodes[i % nodes.size()])
+                );
+            }
+            break;
+        }
+        case placement::none:
+            break;
+    }
+}
+
+void io_context_pool::start() {
+    for (size_t i = 0; i < ctx_num; ++i) {
+        contexts[i].start();
+    }
+}
+
+void io_context_pool::join() {
+    for (size_t i = 0; i < ctx_num; ++i) {
+        contexts[i].join();
+    }
+}
+
+task<void>
+io_context_pool::counted(task<void> entrance, std::atomic<uint32_t> &load) {
+    defer _{[&load] { load.fetch_sub(1, std::memory_order_relaxed); }};
+    co_await entrance;
+}
+
+void io_context_pool::spawn_on(size_t i, task<void> &&entrance) noexcept {
+    auto &load = loads[i].value;
+    load.fetch_add(1, std::memory_order_relaxed);
+    contexts[i].co_spawn(counted(std::move(entrance), load));
+}
+
+void io_context_pool::spawn_any(task<void> &&entrance) noexcept {
+    const size_t first = turn.fetch_add(1, std::memory_order_relaxed) % ctx_num;
+    size_t chosen = first;
+    uint32_t min_load = load_of(first);
+    for (size_t k = 1; k < ctx_num && min_load != 0; ++k) {
+        const size_t i = (first + k) % ctx_num;
+        const uint32_t load = load_of(i);
+        if (load < min_load) {
+            chosen = i;
+            min_load = load;
+        }
+    }
+    spawn_on(chosen, std::move(entrance));
+}
+
+} // namespace co_context
@@ -0,0 +1,295 @@
+#include <co_context/config/config.hpp>
+#include <co_context/detail/latency_histogram.hpp>
+#include <co_context/detail/trace_buffer.hpp>
+#include <co_context/log/log.hpp>
+#include <co_context/trace.hpp>
+
+#include <algorithm>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace co_context::detail {
+
+namespace {
+
+    struct trace_file_header {
+        char magic[8];
+        uint32_t version;
+        uint32_t record_size;
+    };
+
+    constexpr char trace_magic[8] = {'c', 'o', 't', 'r', 'a', 'c', 'e', '\0'};
+    constexpr uint32_t trace_version = 1;
+
+    /**
+     * @brief Owns the binary file, and the thread flushing every trace_buffer
+     * into it.
+     */
+    struct trace_collector {
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::vector<trace_buffer *> buffers;
+        std::FILE *file = nullptr;
+        std::thread flusher;
+        std::chrono::milliseconds period{10};
+        bool is_stopping = false;
+
+        // Called under `mtx`. Records are discarded if no file is open.
+        void flush(trace_buffer &buffer) noexcept {
+            buffer.drain([this](const trace_record *records, uint32_t num) {
+                if (file != nullptr) {
+                    std::fwrite(records, sizeof(trace_record), num, file);
+                }
+            });
+        }
+
+        // Called under `mtx`.
+        void flush_all() noexcept {
+            for (trace_buffer *buffer : buffers) {
+                flush(*buffer);
+            }
+        }
+
+        void run() {
+            std::unique_lock lock{mtx};
+            while (!is_stopping) {
+                cv.wait_for(lock, period, [this] { return is_stopping; });
+                flush_all();
+            }
+        }
+    };
+
+    trace_collector collector; // NOLINT(*global-variables)
+
+} // namespace
+
+void register_trace_buffer(trace_buffer &buffer) {
+    std::lock_guard lg{collector.mtx};
+    collector.buffers.push_back(&buffer);
+}
+
+void unregister_trace_buffer(trace_buffer &buffer) noexcept {
+    std::lock_guard lg{collector.mtx};
+    collector.flush(buffer);
+    std::erase(collector.buffers, &buffer);
+}
+
+} // namespace co_context::detail
+
+namespace co_context {
+
+bool trace_start(
+    [[maybe_unused]] const char *binary_path,
+    [[maybe_unused]] std::chrono::milliseconds flush_period
+) {
+#if CO_CONTEXT_USE_TRACE
+    auto &collector = detail::collector;
+    std::lock_guard lg{collector.mtx};
+    if (collector.file != nullptr) {
+        log::w("trace_start(): tracing is running already\n");
+        return false;
+    }
+
+    std::FILE *const file = std::fopen(binary_path, "wb");
+    if (file == nullptr) {
+        log::e("trace_start(): can not open %s\n", binary_path);
+        return false;
+    }
+    detail::trace_file_header header{};
+    std::memcpy(header.magic, detail::trace_magic, sizeof(header.magic));
+    header.version = detail::trace_version;
+    header.record_size = sizeof(detail::trace_record);
+    std::fwrite(&header, sizeof(header), 1, file);
+
+    // Discard the records left by the last tracing.
+    collector.flush_all();
+
+    collector.file = file;
+    collector.period = flush_period;
+    collector.is_stopping = false;
+    detail::is_tracing.store(true, std::memory_order_relaxed);
+    collector.flusher = std::thread{[&collector] { collector.run(); }};
+    return true;
+#else
+    log::w("trace_start(): co_context is built without ENABLE_TRACE\n");
+    return false;
+#endif
+}
+
+void trace_stop() noexcept {
+#if CO_CONTEXT_USE_TRACE
+    auto &collector = detail::collector;
+    std::thread flusher;
+    {
+        std::lock_guard lg{collector.mtx};
+        if (collector.file == nullptr) {
+            return;
+        }
+        detail::is_tracing.store(false, std::memory_order_relaxed);
+        collector.is_stopping = true;
+        flusher = std::move(collector.flusher);
+    }
+    collector.cv.notify_all();
+    flusher.join();
+
+    std::lock_guard lg{collector.mtx};
+    collector.flush_all();
+    uint64_t dropped = 0;
+    for (const detail::trace_buffer *buffer : collector.buffers) {
+        dropped += buffer->dropped_count();
+    }
+    if (dropped != 0) {
+        log::w("trace_stop(): %" PRIu64 " records are dropped\n", dropped);
+    }
+    std::fclose(collector.file);
+    collector.file = nullptr;
+#endif
+}
+
+namespace {
+
+    void print_event(
+        std::FILE *out,
+        const detail::trace_record &record,
+        uint64_t base_ns
+    ) {
+        using detail::trace_event;
+        const double ts = double(record.ts_ns - base_ns) / 1e3;
+        const unsigned tid = record.ctx_id;
+        const uint64_t coro = record.coro;
+
+        switch (record.event) {
+            case trace_event::spawn:
+                std::fprintf(
+                    out,
+                    R"({"name":"spawn","ph":"i","s":"t","ts":%.3f,"pid":1,)"
+                    R"("tid":%u,"args":{"coro":"0x%)" PRIx64
+                    R"(","to":%u}})",
+                    ts, tid, coro, record.arg
+                );
+                break;
+            case trace_event::resume:
+                std::fprintf(
+                    out,
+                    R"({"name":"coro 0x%)" PRIx64
+                    R"(","ph":"B","ts":%.3f,"pid":1,"tid":%u})",
+                    coro, ts, tid
+                );
+                break;
+            case trace_event::yield:
+                std::fprintf(
+                    out, R"({"ph":"E","ts":%.3f,"pid":1,"tid":%u})", ts, tid
+                );
+                break;
+            case trace_event::suspend_io:
+                std::fprintf(
+                    out,
+                    R"({"name":"%s","cat":"io","ph":"i","s":"t","ts":%.3f,)"
+                    R"("pid":1,"tid":%u,"args":{"coro":"0x%)" PRIx64 R"("}})",
+                    detail::latency_stats::op_name(uint8_t(record.arg)), ts,
+                    tid, coro
+                );
+                break;
+            case trace_event::complete:
+                std::fprintf(
+                    out,
+                    R"({"name":"complete","cat":"io","ph":"i","s":"t",)"
+                    R"("ts":%.3f,"pid":1,"tid":%u,"args":{"coro":"0x%)" PRIx64
+                    R"(","res":%d}})",
+                    ts, tid, coro, int32_t(record.arg)
+                );
+                break;
+            case trace_event::hop_out:
+                std::fprintf(
+                    out,
+                    R"({"name":"hop","cat":"hop","ph":"s","id":"0x%)" PRIx64
+                    R"(","ts":%.3f,"pid":1,"tid":%u,"args":{"to":%u}})",
+                    coro, ts, tid, record.arg
+                );
+                break;
+            case trace_event::hop_in:
+                std::fprintf(
+                    out,
+                    R"({"name":"hop","cat":"hop","ph":"f","id":"0x%)" PRIx64
+                    R"(","ts":%.3f,"pid":1,"tid":%u})",
+                    coro, ts, tid
+                );
+                break;
+        }
+    }
+
+} // namespace
+
+bool trace_to_chrome_json(const char *binary_path, const char *json_path) {
+    std::FILE *const in = std::fopen(binary_path, "rb");
+    if (in == nullptr) {
+        log::e("trace_to_chrome_json(): can not open %s\n", binary_path);
+        return false;
+    }
+    detail::trace_file_header header{};
+    const bool is_valid =
+        std::fread(&header, sizeof(header), 1, in) == 1
+        && std::memcmp(header.magic, detail::trace_magic, sizeof(header.magic))
+               == 0
+        && header.version == detail::trace_version
+        && header.record_size == sizeof(detail::trace_record);
+    if (!is_valid) {
+        log::e("trace_to_chrome_json(): %s is malformed\n", binary_path);
+        std::fclose(in);
+        return false;
+    }
+
+    std::vector<detail::trace_record> records;
+    detail::trace_record record;
+    while (std::fread(&record, sizeof(record), 1, in) == 1) {
+        records.push_back(record);
+    }
+    std::fclose(in);
+
+    // Records of different io_contexts are interleaved by the flusher.
+    std::stable_sort(
+        records.begin(), records.end(),
+        [](const auto &lhs, const auto &rhs) { return lhs.ts_ns < rhs.ts_ns; }
+    );
+
+    std::FILE *const out = std::fopen(json_path, "w");
+    if (out == nullptr) {
+        log::e("trace_to_chrome_json(): can not open %s\n", json_path);
+        return false;
+    }
+
+    std::fputs("{\"traceEvents\":[\n", out);
+    std::set<config::ctx_id_t> ctx_ids;
+    for (const auto &each : records) {
+        ctx_ids.insert(each.ctx_id);
+    }
+    bool is_first = true;
+    for (const config::ctx_id_t id : ctx_ids) {
+        std::fprintf(
+            out,
+            R"(%s{"name":"thread_name","ph":"M","pid":1,"tid":%u,)"
+            R"("args":{"name":"io_context[%u]"}})",
+            is_first ? "" : ",\n", unsigned(id), unsigned(id)
+        );
+        is_first = false;
+    }
+    const uint64_t base_ns = records.empty() ? 0 : records.front().ts_ns;
+    for (const auto &each : records) {
+        if (!is_first) {
+            std::fputs(",\n", out);
+        }
+        is_first = false;
+        print_event(out, each, base_ns);
+    }
+    std::fputs("\n]}\n", out);
+    std::fclose(out);
+    return true;
+}
+
+} // namespace co_context
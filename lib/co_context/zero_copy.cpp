@@ -0,0 +1,58 @@
+#include <co_context/detail/thread_meta.hpp>
+#include <co_context/detail/worker_meta.hpp>
+#include <co_context/zero_copy.hpp>
+
+#include <cassert>
+#include <utility>
+
+#if LIBURINGCXX_IS_KERNEL_REACH(6, 0)
+
+namespace co_context {
+
+namespace detail {
+
+    void zc_send_state::on_cqe(int32_t res, uint32_t flags) noexcept {
+        if (flags & IORING_CQE_F_NOTIF) {
+            assert(pending > 0);
+            if (--pending == 0) {
+                on_released();
+            }
+            return;
+        }
+
+        // The result of the send. Without F_MORE, no notification follows,
+        // e.g. the send fails.
+        task_info *const io_info = std::exchange(sending, nullptr);
+        assert(io_info != nullptr);
+        worker_meta *const worker = this_thread.worker;
+#if CO_CONTEXT_USE_LATENCY_HISTOGRAM
+        io_info->complete_ns = latency_clock_ns();
+        worker->latency.record_in_flight(
+            io_info->opcode, io_info->complete_ns - io_info->submit_ns
+        );
+#endif
+        io_info->result = res;
+        io_info->cqe_flags = uint8_t(flags);
+        trace(trace_event::complete, io_info->handle, uint32_t(res));
+        worker->forward_task(io_info->handle, io_info->prio);
+
+        if ((flags & IORING_CQE_F_MORE) == 0) {
+            if (--pending == 0) {
+                on_released();
+            }
+        }
+    }
+
+} // namespace detail
+
+void zc_notification::on_released() noexcept {
+    if (waiter) {
+        detail::this_thread.worker->forward_task(
+            std::exchange(waiter, nullptr), waiter_prio
+        );
+    }
+}
+
+} // namespace co_context
+
+#endif
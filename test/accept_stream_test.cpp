@@ -0,0 +1,114 @@
+#include "check.hpp"
+
+#include <co_context/io_context.hpp>
+#include <co_context/lazy_io.hpp>
+#include <co_context/net.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+
+using namespace co_context;
+using namespace std::chrono_literals;
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 19)
+
+namespace {
+
+sockaddr_in listen_addr;
+
+int listen_on_loopback() {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(fd >= 0);
+    listen_addr = {};
+    listen_addr.sin_family = AF_INET;
+    listen_addr.sin_addr.s_addr = ::htonl(INADDR_LOOPBACK);
+    auto *const addr = reinterpret_cast<sockaddr *>(&listen_addr);
+    socklen_t len = sizeof(listen_addr);
+    CHECK(::bind(fd, addr, len) == 0);
+    CHECK(::listen(fd, 16) == 0);
+    CHECK(::getsockname(fd, addr, &len) == 0);
+    return fd;
+}
+
+// Completes at once on loopback, by the backlog of the listener.
+int connect_client() {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(fd >= 0);
+    CHECK(
+        ::connect(
+            fd, reinterpret_cast<const sockaddr *>(&listen_addr),
+            sizeof(listen_addr)
+        )
+        == 0
+    );
+    return fd;
+}
+
+bool is_closed_by_peer(int client) {
+    char c;
+    return ::recv(client, &c, 1, MSG_DONTWAIT) == 0;
+}
+
+/**
+ * The connections accepted but not taken are closed when the stream is
+ * dropped, and the cqes of the cancel and of the closes are reaped, so that
+ * the io_context stops by itself.
+ */
+task<> drop_with_queued(int listen_fd, bool is_direct) {
+    std::array<int, 3> clients{};
+    {
+        accept_stream stream{listen_fd, 0, is_direct};
+        clients[0] = connect_client();
+        const int first = co_await stream.next();
+        CHECK(first >= 0);
+        if (is_direct) {
+            CHECK(co_await lazy::close_direct(unsigned(first)) == 0);
+        } else {
+            CHECK(::close(first) == 0);
+        }
+
+        clients[1] = connect_client();
+        clients[2] = connect_client();
+        // Queued in the stream, not taken.
+        co_await lazy::timeout(20ms);
+    }
+    co_await lazy::timeout(20ms);
+    for (const int client : clients) {
+        CHECK(is_closed_by_peer(client));
+        ::close(client);
+    }
+}
+
+void run(bool is_direct) {
+    const int listen_fd = listen_on_loopback();
+    io_context_options options;
+    options.fixed_file_num = is_direct ? 16 : 0;
+    io_context ctx{options};
+    ctx.co_spawn(drop_with_queued(listen_fd, is_direct));
+    ctx.start();
+    ctx.join();
+    ::close(listen_fd);
+}
+
+} // namespace
+
+int main() {
+    // A leaked request keeps the io_context running.
+    ::alarm(10);
+    run(false);
+    run(true);
+    return 0;
+}
+
+#else
+
+int main() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,90 @@
+#include <benchmark/benchmark.h>
+#include <co_context/net.hpp>
+#include <co_context/utility/timing.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+using namespace co_context;
+
+constexpr uint16_t port = 12346;
+constexpr uint32_t total_conn = 20000;
+constexpr uint32_t client_num = 8;
+
+// Connect and reset at once, leaving no TIME_WAIT behind.
+void client(uint32_t conn_num) {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    const linger lg{1, 0};
+
+    for (uint32_t i = 0; i < conn_num; ++i) {
+        const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+        if (::connect(fd, (const sockaddr *)&addr, sizeof(addr)) != 0) {
+            perror("connect");
+        }
+        ::close(fd);
+    }
+}
+
+task<> accept_loop(acceptor &ac) {
+    for (uint32_t i = 0; i < total_conn; ++i) {
+        const int fd = co_await ac.accept();
+        if (fd < 0) [[unlikely]] {
+            continue;
+        }
+        ::close(fd);
+    }
+    this_io_context().can_stop();
+}
+
+task<> accept_by_stream(acceptor &ac) {
+    auto stream = ac.accept_stream();
+    for (uint32_t i = 0; i < total_conn; ++i) {
+        const int fd = co_await stream.next();
+        if (fd < 0) [[unlikely]] {
+            continue;
+        }
+        ::close(fd);
+    }
+    this_io_context().can_stop();
+}
+
+template<task<> (*server)(acceptor &)>
+void perf_accept(benchmark::State &state) {
+    for (auto _ : state) {
+        acceptor ac{inet_address{port}};
+        io_context ctx;
+        ctx.co_spawn(server(ac));
+
+        auto duration = host_timing([&] {
+            ctx.start();
+            std::vector<std::thread> clients;
+            for (uint32_t i = 0; i < client_num; ++i) {
+                clients.emplace_back(client, total_conn / client_num);
+            }
+            for (auto &t : clients) {
+                t.join();
+            }
+            ctx.join();
+        });
+        ::close(ac.listen_fd());
+
+        printf(
+            "Avg. accept time = %3.3f us.\n", duration.count() / total_conn
+        );
+    }
+}
+
+BENCHMARK(perf_accept<accept_loop>);
+
+BENCHMARK(perf_accept<accept_by_stream>);
+
+BENCHMARK_MAIN();
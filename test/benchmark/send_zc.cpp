@@ -0,0 +1,88 @@
+#include <benchmark/benchmark.h>
+#include <co_context/net.hpp>
+
+#include <array>
+#include <vector>
+
+using namespace co_context;
+
+constexpr uint16_t port = 12347;
+constexpr size_t total_bytes = size_t(1) << 30;
+constexpr size_t buffer_num = 4;
+
+// coroutines not finished
+int alive;
+
+void finish() {
+    if (--alive == 0) {
+        this_io_context().can_stop();
+    }
+}
+
+task<> receiver(acceptor &ac) {
+    co_context::socket sock{co_await ac.accept()};
+    std::vector<char> buf(size_t(1) << 20);
+    for (size_t received = 0; received < total_bytes;) {
+        const int nr = co_await sock.recv(buf);
+        if (nr <= 0) [[unlikely]] {
+            break;
+        }
+        received += size_t(nr);
+    }
+    co_await sock.close();
+    finish();
+}
+
+// Send from buffers in turn, reusing one once the kernel drops it.
+task<> sender(size_t size, bool is_zero_copy) {
+    auto sock = co_context::socket::create_tcp(AF_INET);
+    co_await sock.connect(inet_address{"127.0.0.1", port});
+
+    std::array<std::vector<char>, buffer_num> bufs;
+    std::array<zc_notification, buffer_num> notifs;
+    for (auto &buf : bufs) {
+        buf.resize(size, 'x');
+    }
+
+    for (size_t i = 0, sent = 0; sent < total_bytes; ++i) {
+        auto &buf = bufs[i % buffer_num];
+        auto &notif = notifs[i % buffer_num];
+        co_await notif.released();
+        const int nr =
+            is_zero_copy
+                ? co_await lazy::send_zc(sock.fd(), buf, notif, MSG_WAITALL)
+                : co_await lazy::send(sock.fd(), buf, MSG_WAITALL);
+        if (nr <= 0) [[unlikely]] {
+            break;
+        }
+        sent += size_t(nr);
+    }
+    for (auto &notif : notifs) {
+        co_await notif.released();
+    }
+    co_await sock.close();
+    finish();
+}
+
+void perf_send(benchmark::State &state) {
+    const auto size = size_t(state.range(0));
+    const bool is_zero_copy = state.range(1) != 0;
+    for (auto _ : state) {
+        acceptor ac{inet_address{port}};
+        io_context ctx;
+        alive = 2;
+        ctx.co_spawn(receiver(ac));
+        ctx.co_spawn(sender(size, is_zero_copy));
+        ctx.start();
+        ctx.join();
+        ::close(ac.listen_fd());
+    }
+    state.SetBytesProcessed(int64_t(state.iterations() * total_bytes));
+}
+
+BENCHMARK(perf_send)
+    ->ArgsProduct({{1 << 10, 4 << 10, 16 << 10, 64 << 10, 256 << 10}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
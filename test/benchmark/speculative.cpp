@@ -0,0 +1,76 @@
+#include <benchmark/benchmark.h>
+#include <co_context/net.hpp>
+
+#include <vector>
+
+using namespace co_context;
+
+constexpr uint16_t port = 12348;
+constexpr size_t request_size = 16;
+constexpr size_t reply_size = 5;
+constexpr size_t pipeline_depth = 64;
+constexpr size_t request_num = 1 << 16;
+
+// Reply to each request, which is often buffered by the time it is read.
+task<> server(acceptor &ac, bool is_speculative) {
+    co_context::socket sock{co_await ac.accept()};
+    sock.set_tcp_no_delay(true);
+    char buf[request_size];
+    const char reply[reply_size] = {'+', 'O', 'K', '\r', '\n'};
+    for (;;) {
+        const int nr = is_speculative
+                           ? co_await sock.recv_speculative(buf)
+                           : co_await sock.recv(buf);
+        if (nr <= 0) {
+            break;
+        }
+        if (is_speculative) {
+            co_await sock.send_speculative(reply);
+        } else {
+            co_await sock.send(reply);
+        }
+    }
+    co_await sock.close();
+    this_io_context().can_stop();
+}
+
+// Send `pipeline_depth` requests at once, then wait for their replies.
+task<> client() {
+    auto sock = co_context::socket::create_tcp(AF_INET);
+    sock.set_tcp_no_delay(true);
+    co_await sock.connect(inet_address{"127.0.0.1", port});
+    std::vector<char> requests(request_size * pipeline_depth, 'x');
+    std::vector<char> replies(reply_size * pipeline_depth);
+    for (size_t i = 0; i < request_num; i += pipeline_depth) {
+        co_await sock.send(requests);
+        co_await sock.recv(replies, MSG_WAITALL);
+    }
+    co_await sock.shutdown_write();
+}
+
+void perf_pipeline(benchmark::State &state) {
+    const bool is_speculative = state.range(0) != 0;
+    uint64_t hits = 0;
+    for (auto _ : state) {
+        acceptor ac{inet_address{port}};
+        io_context ctx;
+        ctx.co_spawn(server(ac, is_speculative));
+        ctx.co_spawn(client());
+        ctx.start();
+        ctx.join();
+        hits += ctx.metrics().speculative_hits;
+        ::close(ac.listen_fd());
+    }
+    state.SetItemsProcessed(int64_t(state.iterations() * request_num));
+    state.counters["hits"] = benchmark::Counter(
+        double(hits), benchmark::Counter::kAvgIterations
+    );
+}
+
+BENCHMARK(perf_pipeline)
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+#include <co_context/io_context.hpp>
+#include <co_context/lazy_io.hpp>
+#include <co_context/utility/timing.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace co_context;
+
+using clock_type = std::chrono::steady_clock;
+
+constexpr uint32_t ready_num = 16384;
+constexpr uint32_t work_ns = 500;
+
+std::vector<uint64_t> delays;
+uint32_t finished;
+
+void busy_work() {
+    const auto end = clock_type::now() + std::chrono::nanoseconds{work_ns};
+    while (clock_type::now() < end) {}
+}
+
+// Time from preparing an I/O to resuming on its completion.
+task<> io_after_work() {
+    busy_work();
+    const auto start = clock_type::now();
+    co_await lazy::uring_nop();
+    delays.push_back((clock_type::now() - start).count());
+    if (++finished == ready_num) {
+        this_io_context().can_stop();
+    }
+}
+
+template<io_context_options (*preset)()>
+void perf_submission(benchmark::State &state) {
+    for (auto _ : state) {
+        delays.clear();
+        delays.reserve(ready_num);
+        finished = 0;
+
+        io_context ctx{preset()};
+        for (uint32_t i = 0; i < ready_num; ++i) {
+            ctx.co_spawn(io_after_work());
+        }
+        auto duration = host_timing([&] {
+            ctx.start();
+            ctx.join();
+        });
+
+        std::sort(delays.begin(), delays.end());
+        const auto metrics = ctx.metrics();
+        printf(
+            "host %.0f us, I/O delay p50 %lu us, p99 %lu us, "
+            "submits %lu\n",
+            duration.count(), delays[delays.size() / 2] / 1000,
+            delays[delays.size() * 99 / 100] / 1000, metrics.submit_syscalls
+        );
+    }
+}
+
+BENCHMARK(perf_submission<io_context_options::throughput>);
+
+BENCHMARK(perf_submission<io_context_options::latency>);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// Like assert(), but kept under NDEBUG, so that ctest checks release builds.
+#define CHECK(cond)                                                            \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            std::fprintf(                                                      \
+                stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond \
+            );                                                                 \
+            std::exit(1);                                                      \
+        }                                                                      \
+    } while (0)
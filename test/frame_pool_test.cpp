@@ -0,0 +1,102 @@
+#include "check.hpp"
+
+#include <co_context/detail/frame_pool.hpp>
+
+#include <algorithm>
+#include <array>
+#include <latch>
+#include <thread>
+
+using co_context::detail::frame_pool;
+
+namespace {
+
+constexpr size_t frame_size = 100;
+constexpr size_t frame_num = 8;
+
+using frames = std::array<void *, frame_num>;
+
+bool contains(const frames &all, void *ptr) {
+    return std::find(all.begin(), all.end(), ptr) != all.end();
+}
+
+// Frames freed by another thread are reused by the living owner.
+frame_pool *remote_free_to_owner() {
+    frames allocated{};
+    frame_pool *pool = nullptr;
+    std::latch is_allocated{1};
+    std::latch is_freed{1};
+
+    std::thread owner{[&] {
+        pool = &frame_pool::local();
+        for (void *&ptr : allocated) {
+            ptr = frame_pool::allocate(frame_size);
+        }
+        is_allocated.count_down();
+        is_freed.wait();
+
+        const frame_pool::stats before = pool->get_stats();
+        for (size_t i = 0; i < frame_num; ++i) {
+            CHECK(contains(allocated, frame_pool::allocate(frame_size)));
+        }
+        const frame_pool::stats &after = pool->get_stats();
+        CHECK(after.remote_free_count - before.remote_free_count == frame_num);
+        CHECK(after.hit_count - before.hit_count == frame_num);
+        CHECK(after.miss_count == before.miss_count);
+
+        for (void *ptr : allocated) {
+            frame_pool::deallocate(ptr, frame_size);
+        }
+        CHECK(pool->get_stats().remote_free_count == frame_num);
+    }};
+
+    is_allocated.wait();
+    for (void *ptr : allocated) {
+        frame_pool::deallocate(ptr, frame_size);
+    }
+    is_freed.count_down();
+    owner.join();
+    return pool;
+}
+
+// A pool outlives its thread, takes the frames freed after that, and is
+// adopted by the next thread.
+void remote_free_to_orphan(frame_pool *orphan) {
+    void *leftover = nullptr;
+    std::thread{[&] {
+        CHECK(&frame_pool::local() == orphan);
+        leftover = frame_pool::allocate(frame_size);
+    }}.join();
+
+    frame_pool::deallocate(leftover, frame_size);
+
+    std::thread{[&] {
+        CHECK(&frame_pool::local() == orphan);
+        const uint64_t remote_before = orphan->get_stats().remote_free_count;
+        // Drain the free list, where `leftover` was taken from, so that the
+        // remote frame is reclaimed.
+        std::array<void *, frame_num - 1> cached{};
+        for (void *&ptr : cached) {
+            ptr = frame_pool::allocate(frame_size);
+            CHECK(ptr != leftover);
+        }
+        void *const reused = frame_pool::allocate(frame_size);
+        CHECK(reused == leftover);
+        CHECK(orphan->get_stats().remote_free_count == remote_before + 1);
+
+        frame_pool::deallocate(reused, frame_size);
+        for (void *ptr : cached) {
+            frame_pool::deallocate(ptr, frame_size);
+        }
+    }}.join();
+}
+
+} // namespace
+
+int main() {
+    if constexpr (co_context::config::is_using_frame_pool) {
+        frame_pool *const orphan = remote_free_to_owner();
+        remote_free_to_orphan(orphan);
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "check.hpp"
+
+#include <co_context/io_context.hpp>
+#include <co_context/lazy_io.hpp>
+#include <co_context/link_chain.hpp>
+
+#include <cerrno>
+#include <string_view>
+#include <unistd.h>
+
+using namespace co_context;
+
+namespace {
+
+int pipe_fds[2];
+
+// Resumed without suspension, with 0.
+task<> no_step() {
+    link_chain chain;
+    CHECK(chain.empty());
+    CHECK(chain.await_ready());
+    CHECK(co_await chain == 0);
+}
+
+task<> one_step() {
+    link_chain chain;
+    chain.push(lazy::write(pipe_fds[1], std::string_view{"abc"}, 0));
+    CHECK(chain.size() == 1);
+    CHECK(co_await chain == 3);
+    CHECK(chain.result(0) == 3);
+
+    char buf[8];
+    CHECK(::read(pipe_fds[0], buf, sizeof(buf)) == 3);
+    CHECK(std::string_view(buf, 3) == "abc");
+}
+
+// The steps run in order, each keeping its result.
+task<> many_steps() {
+    constexpr std::string_view fragments[] = {"ab", "cde", "f", "ghij"};
+    link_chain chain;
+    for (std::string_view fragment : fragments) {
+        chain.push(lazy::write(pipe_fds[1], fragment, 0));
+    }
+    chain.push(lazy::uring_nop());
+    CHECK(chain.size() == 5);
+    CHECK(co_await chain == 0);
+    for (size_t i = 0; i < 4; ++i) {
+        CHECK(chain.result(i) == int32_t(fragments[i].size()));
+    }
+
+    char buf[16];
+    CHECK(::read(pipe_fds[0], buf, sizeof(buf)) == 10);
+    CHECK(std::string_view(buf, 10) == "abcdefghij");
+}
+
+// A failed step cancels the following ones.
+task<> failed_step() {
+    char buf[8];
+    link_chain chain;
+    chain.push(lazy::uring_nop());
+    chain.push(lazy::read(-1, buf, 0));
+    chain.push(lazy::write(pipe_fds[1], std::string_view{"x"}, 0));
+    chain.push(lazy::uring_nop());
+    CHECK(co_await chain == -ECANCELED);
+    CHECK(chain.result(0) == 0);
+    CHECK(chain.result(1) == -EBADF);
+    CHECK(chain.result(2) == -ECANCELED);
+    CHECK(chain.result(3) == -ECANCELED);
+}
+
+task<> run() {
+    co_await no_step();
+    co_await one_step();
+    co_await many_steps();
+    co_await failed_step();
+
+#if CO_CONTEXT_IS_USING_EVENTFD
+    // The read of the eventfd for co_spawn() is always pending.
+    this_io_context().can_stop();
+#endif
+}
+
+} // namespace
+
+int main() {
+    CHECK(::pipe(pipe_fds) == 0);
+    io_context ctx;
+    ctx.co_spawn(run());
+    ctx.start();
+    ctx.join();
+    ::close(pipe_fds[0]);
+    ::close(pipe_fds[1]);
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "check.hpp"
+
+#include <co_context/io_context.hpp>
+#include <co_context/lazy_io.hpp>
+#include <co_context/net.hpp>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string_view>
+#include <vector>
+
+using namespace co_context;
+using namespace std::chrono_literals;
+
+#if LIBURINGCXX_IS_KERNEL_REACH(5, 20)
+
+namespace {
+
+int fds[2];
+
+void open_pair() {
+    CHECK(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+}
+
+void close_pair() {
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+task<> send(std::string_view msg) {
+    const int res = co_await lazy::send(fds[1], {msg.data(), msg.size()}, 0);
+    CHECK(res == int(msg.size()));
+}
+
+// The cancel of an armed request, and the last cqe of the request, are
+// reaped, so that the io_context stops by itself.
+task<> drop_while_armed() {
+    buffer_group group{4, 16};
+    {
+        recv_stream stream = co_context::socket{fds[0]}.recv_multishot(group);
+        co_spawn(send("abc"));
+        provided_buffer buf = co_await stream.next();
+        CHECK(std::string_view(buf.data(), buf.size()) == "abc");
+        CHECK(buf.result() == 3);
+    }
+    // Let the cancel complete before the group is destructed.
+    co_await lazy::timeout(20ms);
+}
+
+std::vector<provided_buffer> held;
+
+// A stream out of buffers parks, instead of arming again and again, until a
+// buffer is back.
+task<> park_on_enobufs_reader() {
+    buffer_group group{2, 16};
+    recv_stream stream = co_context::socket{fds[0]}.recv_multishot(group);
+    for (int i = 0; i < 3; ++i) {
+        provided_buffer buf = co_await stream.next();
+        CHECK(buf.result() == 3);
+        held.push_back(std::move(buf));
+    }
+    CHECK((co_await stream.next()).result() == 0);
+    CHECK((co_await stream.next()).result() == 0);
+}
+
+task<> park_on_enobufs_writer() {
+    for (int i = 0; i < 3; ++i) {
+        co_await send("abc");
+        co_await lazy::timeout(20ms);
+    }
+    // Both buffers are held, so the third message has none.
+    CHECK(held.size() == 2);
+    const uint64_t before = this_io_context().metrics().sqe_submitted;
+    co_await lazy::timeout(50ms);
+    // Only the timeout above is submitted while parked.
+    CHECK(this_io_context().metrics().sqe_submitted - before <= 2);
+    CHECK(held.size() == 2);
+
+    held.clear();
+    co_await lazy::timeout(20ms);
+    CHECK(held.size() == 1);
+    held.clear();
+    ::shutdown(fds[1], SHUT_WR);
+}
+
+void run(auto &&...entrances) {
+    open_pair();
+    io_context ctx;
+    (ctx.co_spawn(std::move(entrances)), ...);
+    ctx.start();
+    ctx.join();
+    close_pair();
+}
+
+} // namespace
+
+int main() {
+    // A leaked request keeps the io_context running.
+    ::alarm(10);
+    run(drop_while_armed());
+    run(park_on_enobufs_reader(), park_on_enobufs_writer());
+    return 0;
+}
+
+#else
+
+int main() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,70 @@
+#include "check.hpp"
+
+#include <co_context/io_context.hpp>
+#include <co_context/lazy_io.hpp>
+
+#include <string>
+
+using namespace co_context;
+
+namespace {
+
+std::string order;
+
+task<> record(char lane, int i) {
+    order += lane;
+    order += char('0' + i);
+    order += ' ';
+    co_return;
+}
+
+// The last one to run, after the other low ones.
+task<> stop() {
+#if CO_CONTEXT_IS_USING_EVENTFD
+    // The read of the eventfd for co_spawn() is always pending.
+    this_io_context().can_stop();
+#endif
+    co_return;
+}
+
+// The lanes take turns by config::priority_weights, i.e. {16, 4, 1}, and
+// each lane stays FIFO while it spills.
+void weighted_round_robin() {
+    static_assert(config::priority_weights[0] == 16);
+    static_assert(config::priority_weights[1] == 4);
+    static_assert(config::priority_weights[2] == 1);
+
+    io_context_options options;
+    options.swap_capacity = 4;
+    io_context ctx{options};
+    for (int i = 0; i < 10; ++i) {
+        ctx.co_spawn(record('L', i), priority::low);
+        ctx.co_spawn(record('N', i), priority::normal);
+        ctx.co_spawn(record('H', i), priority::high);
+    }
+    ctx.co_spawn(stop(), priority::low);
+    ctx.start();
+    ctx.join();
+
+    CHECK(
+        order
+        == "H0 H1 H2 H3 H4 H5 H6 H7 H8 H9 "
+           "N0 N1 N2 N3 L0 "
+           "N4 N5 N6 N7 L1 "
+           "N8 N9 L2 "
+           "L3 L4 L5 L6 L7 L8 L9 "
+    );
+    for (priority prio : {priority::high, priority::normal, priority::low}) {
+        const auto &stats = ctx.ready_queue_stats(prio);
+        const size_t spawned = prio == priority::low ? 11 : 10;
+        CHECK(stats.overflow_count == spawned - 4);
+        CHECK(stats.max_spill_size == spawned - 4);
+    }
+}
+
+} // namespace
+
+int main() {
+    weighted_round_robin();
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "check.hpp"
+
+#include <co_context/detail/ready_queue.hpp>
+
+#include <cstdint>
+
+using co_context::detail::ready_queue;
+
+namespace {
+
+// Fake handles, only compared and never resumed.
+std::coroutine_handle<> handle_of(uintptr_t i) {
+    return std::coroutine_handle<>::from_address(
+        reinterpret_cast<void *>((i + 1) * 8)
+    );
+}
+
+void fifo_through_spill() {
+    ready_queue q;
+    q.reserve(4);
+    CHECK(q.capacity() == 4);
+
+    uintptr_t pushed = 0;
+    uintptr_t popped = 0;
+    for (; pushed < 10; ++pushed) {
+        q.push(handle_of(pushed));
+    }
+    CHECK(q.size() == 10);
+    CHECK(q.is_spilling());
+
+    // Interleave, so that new ones arrive while the spill area is not empty.
+    for (int round = 0; round < 20; ++round) {
+        CHECK(q.pop() == handle_of(popped++));
+        q.push(handle_of(pushed++));
+        CHECK(q.size() == 10);
+    }
+    while (!q.empty()) {
+        CHECK(q.pop() == handle_of(popped++));
+    }
+    CHECK(popped == pushed);
+    CHECK(q.size() == 0);
+    CHECK(!q.is_spilling());
+
+    const auto &stats = q.get_stats();
+    // Every push of the rounds spilled, since the spill area never emptied.
+    CHECK(stats.overflow_count == 6 + 20);
+    CHECK(stats.max_spill_size == 9);
+}
+
+void drain_back_to_ring() {
+    ready_queue q;
+    q.reserve(3); // rounded up to 4
+    CHECK(q.capacity() == 4);
+    for (uintptr_t i = 0; i < 4; ++i) {
+        q.push(handle_of(i));
+    }
+    CHECK(!q.is_spilling());
+    CHECK(q.get_stats().warning_count == 1);
+
+    q.push(handle_of(4));
+    CHECK(q.is_spilling());
+    for (uintptr_t i = 0; i < 4; ++i) {
+        CHECK(q.pop() == handle_of(i));
+    }
+    // The last pop from the ring drained the spill area.
+    CHECK(!q.is_spilling());
+    CHECK(q.size() == 1);
+    CHECK(q.pop() == handle_of(4));
+    CHECK(q.empty());
+}
+
+} // namespace
+
+int main() {
+    fifo_through_spill();
+    drain_back_to_ring();
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include "check.hpp"
+
+#include <co_context/io_context.hpp>
+#include <co_context/lazy_io.hpp>
+#include <co_context/link_chain.hpp>
+
+#include <cerrno>
+#include <unistd.h>
+
+using namespace co_context;
+
+namespace {
+
+constexpr uint32_t ring_entries = 64;
+
+char buf[8];
+
+/**
+ * A link filling up the sq ring is held back, and submitted whole by a later
+ * submission. A link cut by an early submission would run its tail even
+ * though the head fails.
+ */
+task<> run() {
+    for (uint32_t i = 0; i < ring_entries - 2; ++i) {
+        co_await lazy::uring_nop().detach();
+    }
+    const int res =
+        co_await (lazy::read(-1, buf, 0) && lazy::uring_nop()
+                  && lazy::uring_nop());
+    CHECK(res == -ECANCELED);
+
+    for (uint32_t i = 0; i < ring_entries - 24; ++i) {
+        co_await lazy::uring_nop().detach();
+    }
+    link_chain chain;
+    chain.push(lazy::read(-1, buf, 0));
+    for (uint32_t i = 0; i < ring_entries - 14; ++i) {
+        chain.push(lazy::uring_nop());
+    }
+    CHECK(co_await chain == -ECANCELED);
+    CHECK(chain.result(0) == -EBADF);
+    for (size_t i = 1; i < chain.size(); ++i) {
+        CHECK(chain.result(i) == -ECANCELED);
+    }
+
+    CHECK(this_io_context().metrics().sq_full_submits >= 2);
+
+#if CO_CONTEXT_IS_USING_EVENTFD
+    // The read of the eventfd for co_spawn() is always pending.
+    this_io_context().can_stop();
+#endif
+}
+
+} // namespace
+
+int main() {
+    // A leaked request keeps the io_context running.
+    ::alarm(10);
+    io_context_options options;
+    options.swap_capacity = ring_entries;
+    options.io_uring_entries = ring_entries;
+    io_context ctx{options};
+    ctx.co_spawn(run());
+    ctx.start();
+    ctx.join();
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include "check.hpp"
+
+#include <co_context/io_context.hpp>
+#include <co_context/lazy_io.hpp>
+#include <co_context/net.hpp>
+#include <co_context/zero_copy.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+using namespace co_context;
+using namespace std::chrono_literals;
+
+#if LIBURINGCXX_IS_KERNEL_REACH(6, 0)
+
+namespace {
+
+constexpr size_t msg_size = 32 * 1024;
+constexpr int msg_num = 8;
+
+int sender_fd;
+int receiver_fd;
+
+// A TCP pair on loopback, since zero-copy sends need an inet socket.
+void open_tcp_pair() {
+    const int listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(listen_fd >= 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = ::htonl(INADDR_LOOPBACK);
+    auto *const sa = reinterpret_cast<sockaddr *>(&addr);
+    socklen_t len = sizeof(addr);
+    CHECK(::bind(listen_fd, sa, len) == 0);
+    CHECK(::listen(listen_fd, 1) == 0);
+    CHECK(::getsockname(listen_fd, sa, &len) == 0);
+
+    sender_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(sender_fd >= 0);
+    CHECK(::connect(sender_fd, sa, len) == 0);
+    receiver_fd = ::accept(listen_fd, nullptr, nullptr);
+    CHECK(receiver_fd >= 0);
+    ::close(listen_fd);
+}
+
+void close_tcp_pair() {
+    ::close(sender_fd);
+    ::close(receiver_fd);
+}
+
+task<> receive_all(size_t total) {
+    std::vector<char> buf(msg_size);
+    size_t received = 0;
+    while (received < total) {
+        const int res = co_await lazy::recv(receiver_fd, buf, 0);
+        CHECK(res > 0);
+        for (int i = 0; i < res; ++i) {
+            CHECK(buf[i] == char((received + i) % 251));
+        }
+        received += size_t(res);
+    }
+}
+
+void fill(std::span<char> buf, size_t offset) {
+    for (size_t i = 0; i < buf.size(); ++i) {
+        buf[i] = char((offset + i) % 251);
+    }
+}
+
+/**
+ * Each zero-copy send resumes on its result, and its notification is reaped
+ * afterwards, so that the io_context stops by itself.
+ */
+task<> send_notified() {
+    std::vector<char> buf(msg_size * msg_num);
+    fill(buf, 0);
+    zc_notification notif;
+    for (int i = 0; i < msg_num; ++i) {
+        const auto part = std::span{buf}.subspan(i * msg_size, msg_size);
+        CHECK(co_await lazy::send_zc(sender_fd, part, notif) == int(msg_size));
+    }
+    co_await notif.released();
+    CHECK(!notif.is_pending());
+}
+
+// A failed send posts no notification.
+task<> send_failed() {
+    char byte = 0;
+    zc_notification notif;
+    const int res = co_await lazy::send_zc(-1, {&byte, 1}, notif);
+    CHECK(res == -EBADF);
+    CHECK(!notif.is_pending());
+}
+
+// A lease goes back to the pool once the kernel drops it.
+task<> send_lease() {
+    fixed_buffer_pool &pool = this_io_context().fixed_buffers();
+    CHECK(pool.available() == pool.capacity());
+    co_context::socket sock{sender_fd};
+    for (int i = 0; i < msg_num; ++i) {
+        fixed_buffer buf = pool.try_acquire();
+        CHECK(bool(buf));
+        fill(buf.span().first(msg_size), i * msg_size);
+        CHECK(
+            co_await sock.send_zc(std::move(buf), msg_size) == int(msg_size)
+        );
+    }
+    for (int i = 0; i < 100 && pool.available() != pool.capacity(); ++i) {
+        co_await lazy::timeout(10ms);
+    }
+    CHECK(pool.available() == pool.capacity());
+}
+
+template<typename... Tasks>
+void run(const io_context_options &options, Tasks &&...entrances) {
+    open_tcp_pair();
+    io_context ctx{options};
+    (ctx.co_spawn(std::move(entrances)), ...);
+    ctx.start();
+    ctx.join();
+    close_tcp_pair();
+}
+
+bool has_send_zc() {
+    bool is_supported = false;
+    io_context ctx;
+    ctx.co_spawn([](bool &out) -> task<> {
+        out = this_io_context().features().has_send_zc();
+        co_return;
+    }(is_supported));
+    ctx.start();
+    ctx.join();
+    return is_supported;
+}
+
+} // namespace
+
+int main() {
+    if (!has_send_zc()) {
+        return 0;
+    }
+    // A leaked request keeps the io_context running.
+    ::alarm(10);
+
+    io_context_options options;
+    options.send_zc_min_bytes = 0;
+    run(options, send_notified(), receive_all(msg_size * msg_num));
+    run(options, send_failed());
+
+    options.fixed_buffer_num = 4;
+    options.fixed_buffer_size = msg_size;
+    run(options, send_lease(), receive_all(msg_size * msg_num));
+    return 0;
+}
+
+#else
+
+int main() {
+    return 0;
+}
+
+#endif